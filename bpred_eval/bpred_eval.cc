@@ -0,0 +1,260 @@
+//
+// bpred_eval: streams a trace through branch predictor modules, without the rest of the core
+//
+
+/*
+
+  The trace is decoded by the same TRACE_READER as the simulator, so the branches, their types
+  and their order are the ones the simulated core predicts. Every branch is predicted and then
+  resolved right away, as the core does when the branch predictor reads it from the trace.
+
+  Build with ./build_bpred_eval.sh [branch_pred]..., which links every given branch/<name>.bpred
+  module into one binary. The modules see the same branches, chunk by chunk; with -threads,
+  every module runs in its own thread while the next chunk is decoded.
+
+ */
+
+#include <getopt.h>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "bpred_eval.h"
+#include "trace_reader.h"
+
+#define BPRED_CHUNK (1 << 16) // branches decoded at once
+#define BPRED_TOP_IPS 10 // mispredicted IPs listed by default
+
+const string branch_type_names[8] = { "NOT_BRANCH", "BRANCH_DIRECT_JUMP", "BRANCH_INDIRECT", "BRANCH_CONDITIONAL",
+                                      "BRANCH_DIRECT_CALL", "BRANCH_INDIRECT_CALL", "BRANCH_RETURN", "BRANCH_OTHER" };
+
+class BRANCH_RECORD {
+  public:
+    uint64_t ip;
+    uint8_t  taken,
+             type,
+             roi; // past warmup
+
+    BRANCH_RECORD() {
+        ip = 0;
+        taken = 0;
+        type = NOT_BRANCH;
+        roi = 0;
+    };
+};
+
+class IP_STATS {
+  public:
+    uint64_t branches,
+             mispredictions;
+
+    IP_STATS() {
+        branches = 0;
+        mispredictions = 0;
+    };
+};
+
+class BPRED_STATS {
+  public:
+    uint64_t branches[8],
+             mispredictions[8];
+    map<uint64_t, IP_STATS> ip_stats;
+
+    BPRED_STATS() {
+        for (uint32_t i=0; i<8; i++) {
+            branches[i] = 0;
+            mispredictions[i] = 0;
+        }
+    };
+};
+
+static void predict_chunk(BPRED_MODULE *module, BPRED_STATS *stats, const vector<BRANCH_RECORD> *chunk)
+{
+    for (size_t i=0; i<chunk->size(); i++) {
+        const BRANCH_RECORD &branch = (*chunk)[i];
+
+        uint8_t prediction = module->predict(branch.ip);
+        module->update(branch.ip, branch.taken);
+
+        if (!branch.roi)
+            continue;
+
+        uint8_t mispredicted = (prediction != branch.taken);
+        stats->branches[branch.type]++;
+        stats->mispredictions[branch.type] += mispredicted;
+
+        IP_STATS &ip_stats = stats->ip_stats[branch.ip];
+        ip_stats.branches++;
+        ip_stats.mispredictions += mispredicted;
+    }
+}
+
+static bool more_mispredictions(const pair<uint64_t, IP_STATS> &a, const pair<uint64_t, IP_STATS> &b)
+{
+    if (a.second.mispredictions != b.second.mispredictions)
+        return a.second.mispredictions > b.second.mispredictions;
+    return a.first < b.first;
+}
+
+static void print_stats(BPRED_MODULE *module, BPRED_STATS *stats, uint64_t instructions, uint32_t top_ips)
+{
+    uint64_t branches = 0, mispredictions = 0;
+    for (uint32_t i=0; i<8; i++) {
+        branches += stats->branches[i];
+        mispredictions += stats->mispredictions[i];
+    }
+
+    cout << endl << module->name << " Branch Prediction Accuracy: " << (100.0*(branches - mispredictions)) / branches;
+    cout << "% MPKI: " << (1000.0*mispredictions) / instructions << endl;
+
+    cout << "Branch types" << endl;
+    for (uint32_t i=1; i<8; i++) {
+        cout << setw(20) << left << branch_type_names[i] << right << "  BRANCHES: " << setw(10) << stats->branches[i];
+        cout << "  MISPREDICTIONS: " << setw(10) << stats->mispredictions[i];
+        cout << "  MPKI: " << (1000.0*stats->mispredictions[i]) / instructions << endl;
+    }
+
+    vector<pair<uint64_t, IP_STATS> > ips(stats->ip_stats.begin(), stats->ip_stats.end());
+    size_t top = min((size_t) top_ips, ips.size());
+    partial_sort(ips.begin(), ips.begin() + top, ips.end(), more_mispredictions);
+
+    cout << "Top " << top << " mispredicted IPs" << endl;
+    for (size_t i=0; i<top; i++) {
+        cout << "IP: 0x" << hex << setw(12) << left << ips[i].first << dec << right;
+        cout << "  BRANCHES: " << setw(10) << ips[i].second.branches << "  MISPREDICTIONS: " << setw(10) << ips[i].second.mispredictions;
+        cout << "  MPKI: " << (1000.0*ips[i].second.mispredictions) / instructions << endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    cout << endl << "*** ChampSim Branch Predictor Evaluation ***" << endl << endl;
+
+    uint64_t warmup_instructions = 1000000,
+             simulation_instructions = 10000000;
+    uint8_t  cloudsuite = 0,
+             threads = 0;
+    uint32_t top_ips = BPRED_TOP_IPS;
+
+    int c;
+    while (1) {
+        static struct option long_options[] =
+        {
+            {"warmup_instructions", required_argument, 0, 'w'},
+            {"simulation_instructions", required_argument, 0, 'i'},
+            {"cloudsuite", no_argument, 0, 'c'},
+            {"threads", no_argument, 0, 'p'},
+            {"top_ips", required_argument, 0, 'n'},
+            {"traces",  no_argument, 0, 't'},
+            {0, 0, 0, 0}
+        };
+
+        int option_index = 0;
+
+        c = getopt_long_only(argc, argv, "wi", long_options, &option_index);
+
+        // no more option characters
+        if (c == -1)
+            break;
+
+        int traces_encountered = 0;
+
+        switch(c) {
+            case 'w':
+                warmup_instructions = atol(optarg);
+                break;
+            case 'i':
+                simulation_instructions = atol(optarg);
+                break;
+            case 'c':
+                cloudsuite = 1;
+                break;
+            case 'p':
+                threads = 1;
+                break;
+            case 'n':
+                top_ips = atol(optarg);
+                break;
+            case 't':
+                traces_encountered = 1;
+                break;
+            default:
+                abort();
+        }
+
+        if (traces_encountered == 1)
+            break;
+    }
+
+    if (optind >= argc) {
+        cerr << "Usage: " << argv[0] << " [-warmup_instructions N] [-simulation_instructions N] [-cloudsuite] [-threads] [-top_ips N] -traces TRACE" << endl;
+        assert(0);
+    }
+
+    cout << "Warmup Instructions: " << warmup_instructions << endl;
+    cout << "Simulation Instructions: " << simulation_instructions << endl;
+    if (threads)
+        cout << "One thread per branch predictor" << endl;
+
+    TRACE_READER trace;
+    cout << "Trace: " << argv[optind] << endl << endl;
+    trace.open(0, argv[optind], cloudsuite);
+
+    uint32_t num_modules = 0;
+    while (bpred_modules[num_modules])
+        bpred_modules[num_modules++]->initialize();
+    vector<BPRED_STATS> stats(num_modules);
+
+    time_t start_time = time(NULL);
+
+    // decode the next chunk while the modules predict the last one
+    vector<BRANCH_RECORD> chunks[2];
+    uint32_t current = 0;
+    uint64_t instructions = 0;
+    vector<thread> workers;
+    while (1) {
+        vector<BRANCH_RECORD> &chunk = chunks[current];
+        chunk.clear();
+
+        while ((chunk.size() < BPRED_CHUNK) && (instructions < (warmup_instructions + simulation_instructions))) {
+            ooo_model_instr instr;
+            if (trace.read(&instr) == 0)
+                continue;
+            instructions++;
+
+            if (!instr.is_branch)
+                continue;
+
+            BRANCH_RECORD branch;
+            branch.ip = instr.ip;
+            branch.taken = instr.branch_taken;
+            branch.type = instr.branch_type;
+            branch.roi = (instructions > warmup_instructions);
+            chunk.push_back(branch);
+        }
+
+        for (size_t i=0; i<workers.size(); i++)
+            workers[i].join();
+        workers.clear();
+
+        if (chunk.empty())
+            break;
+
+        for (uint32_t i=0; i<num_modules; i++) {
+            if (threads)
+                workers.push_back(thread(predict_chunk, bpred_modules[i], &stats[i], &chunk));
+            else
+                predict_chunk(bpred_modules[i], &stats[i], &chunk);
+        }
+
+        current ^= 1;
+    }
+
+    uint64_t elapsed_second = (uint64_t) (time(NULL) - start_time);
+    cout << endl << "Finished " << instructions << " instructions (Simulation time: " << elapsed_second << " sec)" << endl;
+
+    for (uint32_t i=0; i<num_modules; i++)
+        print_stats(bpred_modules[i], &stats[i], simulation_instructions, top_ips);
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef BPRED_EVAL_H
+#define BPRED_EVAL_H
+
+// the headers the branch/*.bpred modules include, which must not be included for the first
+// time inside the namespace of a module
+#include <math.h>
+
+#include "champsim.h"
+#include "instruction.h"
+
+// one branch/*.bpred module; build_bpred_eval.sh compiles every module in its own namespace,
+// so their globals do not clash, and defines its BPRED_MODULE with BPRED_MODULE_DEFINE
+class BPRED_MODULE {
+  public:
+    const char *name;
+    void    (*initialize)();
+    uint8_t (*predict)(uint64_t ip);
+    void    (*update)(uint64_t ip, uint8_t taken);
+};
+
+#define BPRED_MODULE_DEFINE(module) \
+    static bpred_##module::O3_CPU module##_core; \
+    static void module##_initialize() { module##_core.initialize_branch_predictor(); } \
+    static uint8_t module##_predict(uint64_t ip) { return module##_core.predict_branch(ip); } \
+    static void module##_update(uint64_t ip, uint8_t taken) { module##_core.last_branch_result(ip, taken); } \
+    BPRED_MODULE bpred_module_##module = { #module, module##_initialize, module##_predict, module##_update };
+
+// the modules that were built in, NULL terminated
+extern BPRED_MODULE *bpred_modules[];
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef OOO_CPU_H
+#define OOO_CPU_H
+
+// stands in for inc/ooo_cpu.h when bpred_eval compiles a branch/*.bpred module, which only
+// needs the branch predictor interface of the core
+
+class O3_CPU {
+  public:
+    uint32_t cpu;
+
+    O3_CPU() {
+        cpu = 0;
+    };
+
+    // branch predictor
+    void    initialize_branch_predictor();
+    uint8_t predict_branch(uint64_t ip);
+    void    last_branch_result(uint64_t ip, uint8_t taken);
+};
+
+#endif
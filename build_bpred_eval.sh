@@ -0,0 +1,69 @@
+#!/bin/bash
+
+if [ "$#" -lt 1 ]; then
+    echo "Illegal number of parameters"
+    echo "Usage: ./build_bpred_eval.sh [branch_pred] [branch_pred] ..."
+    exit 1
+fi
+
+# Branch predictor evaluation configuration: the branch/*.bpred modules to compare
+BRANCHES="$@"
+
+############## Some useful macros ###############
+BOLD=$(tput bold)
+NORMAL=$(tput sgr0)
+#################################################
+
+# Sanity check
+for BRANCH in ${BRANCHES}; do
+    if [ ! -f ./branch/${BRANCH}.bpred ]; then
+        echo "[ERROR] Cannot find branch predictor ${BRANCH}"
+        echo "[ERROR] Possible branch predictors from branch/*.bpred "
+        find branch -name "*.bpred"
+        exit 1
+    fi
+done
+
+# Every module goes into its own namespace, so their globals do not clash
+GEN_DIR=obj/bpred_eval
+rm -rf ${GEN_DIR}
+mkdir -p ${GEN_DIR} bin
+
+MODULES=${GEN_DIR}/modules.cc
+echo "#include \"bpred_eval.h\"" > ${MODULES}
+for BRANCH in ${BRANCHES}; do
+    cat > ${GEN_DIR}/${BRANCH}.cc <<EOF
+#include "bpred_eval.h"
+
+namespace bpred_${BRANCH} {
+#include "${BRANCH}.bpred"
+}
+
+BPRED_MODULE_DEFINE(${BRANCH})
+EOF
+    echo "extern BPRED_MODULE bpred_module_${BRANCH};" >> ${MODULES}
+done
+echo "BPRED_MODULE *bpred_modules[] = {" >> ${MODULES}
+for BRANCH in ${BRANCHES}; do
+    echo "    &bpred_module_${BRANCH}," >> ${MODULES}
+done
+echo "    NULL };" >> ${MODULES}
+
+# Build
+BINARY_NAME="bpred_eval-$(echo ${BRANCHES} | tr ' ' '-')"
+rm -f bin/${BINARY_NAME}
+${CXX:-g++} -Wall -O3 -std=c++11 -pthread -Ibpred_eval -Iinc -Ibranch \
+    bpred_eval/bpred_eval.cc src/trace_reader.cc ${GEN_DIR}/*.cc -o bin/${BINARY_NAME}
+
+# Sanity check
+echo ""
+if [ ! -f bin/${BINARY_NAME} ]; then
+    echo "${BOLD}Branch predictor evaluation build FAILED!"
+    echo ""
+    exit 1
+fi
+
+echo "${BOLD}Branch predictor evaluation is successfully built"
+echo "Branch Predictors: ${BRANCHES}"
+echo "Binary: bin/${BINARY_NAME}"
+echo ""
@@ -0,0 +1,95 @@
+#ifndef BINGO_H
+#define BINGO_H
+
+#include "champsim.h"
+
+// BINGO SPATIAL DATA PREFETCHER (Bakhshalipour et al., HPCA 2019)
+#define BINGO_LOG2_REGION 11 // 2KB regions
+#define BINGO_REGION_BLOCKS (1 << (BINGO_LOG2_REGION - LOG2_BLOCK_SIZE))
+#define BINGO_AT_SIZE 64 // regions accumulating their footprint
+#define BINGO_PHT_SET 1024
+#define BINGO_PHT_WAY 16
+#define BINGO_VOTE 20 // percent of the PC+offset matches a block needs to be prefetched
+
+#if (BINGO_REGION_BLOCKS > 64) || (BINGO_LOG2_REGION > LOG2_PAGE_SIZE)
+#error "a Bingo region must fit in a page and have at most 64 blocks"
+#endif
+
+#if (BINGO_PHT_WAY > 256)
+#error "the LRU position of a Bingo pattern must fit in 8 bits"
+#endif
+
+// a region touched since its trigger access, and the blocks touched so far
+class BINGO_REGION {
+  public:
+    uint8_t  valid;
+    uint64_t region,
+             ip,
+             footprint;
+    uint32_t offset, // of the trigger access
+             lru;
+
+    BINGO_REGION() {
+        valid = 0;
+        region = 0;
+        ip = 0;
+        footprint = 0;
+        offset = 0;
+        lru = 0;
+    };
+};
+
+// a footprint, found by PC+address (long event) or, failing that, by PC+offset (short event),
+// largest field first so an entry takes 16 bytes
+class BINGO_PATTERN {
+  public:
+    uint64_t footprint;
+    uint32_t long_tag;
+    uint16_t short_tag;
+    uint8_t  lru,
+             valid;
+
+    BINGO_PATTERN() {
+        footprint = 0;
+        long_tag = 0;
+        short_tag = 0;
+        lru = 0;
+        valid = 0;
+    };
+};
+
+class BINGO {
+  public:
+    BINGO_REGION  at[BINGO_AT_SIZE];
+    BINGO_PATTERN pht[BINGO_PHT_SET][BINGO_PHT_WAY];
+
+    // stats
+    uint64_t triggers,
+             long_hits,
+             short_hits,
+             generations;
+
+    BINGO();
+
+    // returns the blocks of the region of addr to prefetch (one bit per block), which are only
+    // predicted on the first access to a region
+    uint64_t access(uint64_t addr, uint64_t ip);
+
+    // a block left the cache, so the footprint of its region is complete
+    void evict(uint64_t addr);
+
+    void print_stats(string name);
+
+  private:
+    void     end_generation(BINGO_REGION &entry);
+    uint64_t predict(uint64_t ip, uint64_t cl_addr);
+
+    static uint32_t long_hash(uint64_t ip, uint64_t cl_addr) {
+        return (uint32_t) (((ip << 24) ^ cl_addr) * 0x9E3779B97F4A7C15ull >> 32);
+    }
+    static uint32_t short_hash(uint64_t ip, uint32_t offset) {
+        return (uint32_t) (((ip << 6) ^ offset) * 0x9E3779B97F4A7C15ull >> 32);
+    }
+};
+
+#endif
@@ -5,6 +5,8 @@
 #include "instruction.h"
 #include "set.h"
 
+class PF_TIMELINESS;
+
 // CACHE BLOCK
 class BLOCK {
   public:
@@ -24,7 +26,11 @@ class BLOCK {
              data,
              ip,
              cpu,
-             instr_id;
+             instr_id,
+             fill_cycle;
+
+    // prefetcher that brought the block in, NULL unless it was prefetched into its target level
+    PF_TIMELINESS *pf_source;
 
     // replacement state
     uint32_t lru;
@@ -46,6 +52,9 @@ class BLOCK {
         data = 0;
         cpu = 0;
         instr_id = 0;
+        fill_cycle = 0;
+
+        pf_source = NULL;
 
         lru = 0;
     };
@@ -73,7 +82,11 @@ class PACKET {
             translated,
             fetched,
             prefetched,
-            drc_tag_read;
+            drc_tag_read,
+            dirty, // data differs from memory, only tracked across an exclusive LLC or from another core's copy
+            coherence_miss, // miss caused by another core's write (or this core's upgrade)
+            coherence_resolved, // the directory already handled this request (-shared_address_space)
+            wrong_path; // issued down a mispredicted path (-wrong_path), no instruction waits for it
 
     int fill_level, 
         pf_origin_level,
@@ -86,6 +99,7 @@ class PACKET {
         confidence;
 
     uint32_t pf_metadata;
+    PF_TIMELINESS *pf_source; // stats of the prefetcher that issued a prefetch
 
     uint8_t  is_producer, 
              //rob_index_depend_on_me[ROB_SIZE], 
@@ -126,6 +140,10 @@ class PACKET {
         fetched = 0;
         prefetched = 0;
         drc_tag_read = 0;
+        dirty = 0;
+        coherence_miss = 0;
+        coherence_resolved = 0;
+        wrong_path = 0;
 
         returned = 0;
         asid[0] = UINT8_MAX;
@@ -140,6 +158,7 @@ class PACKET {
         depth = 0;
         signature = 0;
         confidence = 0;
+        pf_source = NULL;
 
 #if 0
         for (uint32_t i=0; i<ROB_SIZE; i++) {
@@ -177,7 +196,8 @@ class PACKET_QUEUE {
 
     uint8_t  is_RQ, 
              is_WQ,
-             write_mode;
+             write_mode,
+             match_cpu; // only merge requests from the same cpu (shared address space)
 
     uint32_t cpu, 
              head, 
@@ -206,6 +226,7 @@ class PACKET_QUEUE {
         is_RQ = 0;
         is_WQ = 0;
         write_mode = 0;
+        match_cpu = 0;
 
         cpu = 0; 
         head = 0;
@@ -234,6 +255,7 @@ class PACKET_QUEUE {
     PACKET_QUEUE() {
         is_RQ = 0;
         is_WQ = 0;
+        match_cpu = 0;
 
         cpu = 0; 
         head = 0;
@@ -332,7 +354,8 @@ class LSQ_ENTRY {
              virtual_address,
              physical_address,
              ip,
-             event_cycle;
+             event_cycle,
+             issue_cycle; // sent to the L1D
 
     uint32_t rob_index, data_index, sq_index;
 
@@ -351,6 +374,7 @@ class LSQ_ENTRY {
         physical_address = 0;
         ip = 0;
         event_cycle = 0;
+        issue_cycle = 0;
 
         rob_index = 0;
         data_index = 0;
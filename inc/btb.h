@@ -0,0 +1,110 @@
+#ifndef BTB_H
+#define BTB_H
+
+#include "champsim.h"
+#include "instruction.h"
+
+// BRANCH TARGET PREDICTION (only used with -btb)
+#define BTB_SET 512
+#define BTB_WAY 8
+#define RAS_SIZE 32 // return address stack depth, the oldest calls are lost on overflow
+#define RAS_CALL_SIZE_TRACKERS 1024 // learned call instruction sizes, by call ip
+
+// ITTAGE indirect target predictor (Seznec, JILP CBP-3 2011): a tagged table per history
+// length, and the BTB target as the base prediction
+#define ITTAGE_TABLES 4
+#define ITTAGE_LOG2_SIZE 9
+#define ITTAGE_TAG_BITS 12
+#define ITTAGE_CONF_MAX 3
+#define ITTAGE_USEFUL_MAX 3
+
+#if (BTB_SET & (BTB_SET - 1)) || (RAS_CALL_SIZE_TRACKERS & (RAS_CALL_SIZE_TRACKERS - 1))
+#error "BTB_SET and RAS_CALL_SIZE_TRACKERS must be powers of two"
+#endif
+
+class BTB_ENTRY {
+  public:
+    uint64_t ip, // 0 while invalid
+             target;
+    uint32_t lru;
+
+    BTB_ENTRY() {
+        ip = 0;
+        target = 0;
+        lru = 0;
+    };
+};
+
+class ITTAGE_ENTRY {
+  public:
+    uint16_t tag;
+    uint64_t target; // 0 while invalid
+    uint8_t  conf,
+             useful;
+
+    ITTAGE_ENTRY() {
+        tag = 0;
+        target = 0;
+        conf = 0;
+        useful = 0;
+    };
+};
+
+// predicts where the taken branches go: direct branches from the BTB, returns from the RAS and
+// indirect jumps and calls from ITTAGE
+class TARGET_PREDICTOR {
+  public:
+    BTB_ENTRY    btb[BTB_SET][BTB_WAY];
+    ITTAGE_ENTRY ittage[ITTAGE_TABLES][1 << ITTAGE_LOG2_SIZE];
+
+    uint64_t ras[RAS_SIZE];
+    uint32_t ras_top, // the next free entry
+             ras_count,
+             call_size[RAS_CALL_SIZE_TRACKERS];
+
+    uint64_t path_history; // two bits of every taken branch, youngest in the low bits
+
+    // the last lookup, which update() completes
+    uint32_t last_set,
+             last_way;
+    uint8_t  last_hit;
+    uint64_t last_target,
+             last_call_ip; // popped by a return, 0 if the RAS was empty
+    int      last_provider,
+             last_alt;
+    uint64_t last_alt_target;
+
+    // stats
+    uint64_t lookups,
+             misses, // taken branches that were not in the BTB
+             returns,
+             return_mispredicts,
+             indirects,
+             indirect_mispredicts,
+             decode_redirects;
+
+    TARGET_PREDICTOR();
+
+    // the predicted target of the branch at ip, which decode classified as branch_type, and 0 if
+    // it is unknown; hit tells whether the BTB knew the branch, otherwise fetch only finds out
+    // about it at decode
+    uint64_t predict(uint64_t ip, uint8_t branch_type, uint8_t &hit);
+
+    // the branch predict() was last called for resolved
+    void update(uint64_t ip, uint8_t branch_type, uint8_t taken, uint64_t target);
+
+    void reset_stats();
+    void print_stats(uint32_t cpu);
+
+  private:
+    uint64_t ittage_predict(uint64_t ip, uint64_t base_target);
+    void     ittage_update(uint64_t ip, uint64_t target);
+
+    static const uint32_t history_bits[ITTAGE_TABLES];
+
+    uint32_t ittage_index(uint64_t ip, int table);
+    uint16_t ittage_tag(uint64_t ip, int table);
+    uint64_t fold_history(uint32_t length, uint32_t bits);
+};
+
+#endif
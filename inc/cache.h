@@ -2,10 +2,19 @@
 #define CACHE_H
 
 #include "memory_class.h"
+#include "set_dueling.h"
+#include "reuse_profile.h"
+#include "fdp.h"
+#include "pf_timeliness.h"
 
 // PAGE
 extern uint32_t PAGE_TABLE_LATENCY, SWAP_LATENCY;
 
+class DIRECTORY;
+class UCP;
+class PC_PROFILER;
+class PREFETCHER;
+
 // CACHE TYPE
 #define IS_ITLB 0
 #define IS_DTLB 1
@@ -15,6 +24,8 @@ extern uint32_t PAGE_TABLE_LATENCY, SWAP_LATENCY;
 #define IS_L2C  5
 #define IS_LLC  6
 
+constexpr bool is_tlb_level(uint8_t level) { return (level == IS_ITLB) || (level == IS_DTLB) || (level == IS_STLB); }
+
 // INSTRUCTION TLB
 #define ITLB_SET 16
 #define ITLB_WAY 4
@@ -78,11 +89,54 @@ extern uint32_t PAGE_TABLE_LATENCY, SWAP_LATENCY;
 #define LLC_MSHR_SIZE NUM_CPUS*64
 #define LLC_LATENCY 20  // 4/5 (L1I or L1D) + 10 + 20 = 34/35 cycles
 
+// INCLUSION POLICY (of a cache with respect to the caches above it)
+#define NON_INCLUSIVE 0
+#define INCLUSIVE 1 // evictions back-invalidate every upper level
+#define EXCLUSIVE 2 // filled only by upper level victims, hits move the line up
+#define L2C_INCLUSION NON_INCLUSIVE
+#define LLC_INCLUSION NON_INCLUSIVE
+
+#if L2C_INCLUSION == EXCLUSIVE
+#error "EXCLUSIVE is only supported for the LLC"
+#endif
+
+// REPLACEMENT POLICY (of every cache but the LLC, which uses replacement/*.llc_repl)
+#define REPL_LRU    0
+#define REPL_PLRU   1 // tree pseudo-LRU
+#define REPL_SRRIP  2
+#define REPL_DRRIP  3
+#define REPL_SHIP   4
+#define REPL_RANDOM 5
+#define REPL_EXTERNAL 6 // an LLC policy with its own algorithm, which may keep per-line bytes in repl_state
+#define maxRRPV 3 // 2-bit RRPVs, for every RRIP-based policy
+#define ITLB_REPLACEMENT REPL_LRU
+#define DTLB_REPLACEMENT REPL_LRU
+#define STLB_REPLACEMENT REPL_LRU
+#define L1I_REPLACEMENT  REPL_LRU
+#define L1D_REPLACEMENT  REPL_LRU
+#define L2C_REPLACEMENT  REPL_LRU
+
+// PREFETCHER CHAIN (built-in prefetchers run in order after the one from prefetcher/*.l?_pref,
+// e.g. #define L2C_PREFETCH_CHAIN PF_IP_STRIDE, PF_STREAM; the L1I prefetcher lives in O3_CPU)
+#define PF_NONE      0
+#define PF_NEXT_LINE 1
+#define PF_IP_STRIDE 2
+#define PF_STREAM    3
+#define L1D_PREFETCH_CHAIN
+#define L2C_PREFETCH_CHAIN
+#define LLC_PREFETCH_CHAIN
+#define PF_FILTER_SIZE 256 // recently issued prefetches, dropped when requested again (caches with a chain only)
+
+#if (PF_FILTER_SIZE & (PF_FILTER_SIZE - 1))
+#error "PF_FILTER_SIZE must be a power of two"
+#endif
+
 class CACHE : public MEMORY {
   public:
     uint32_t cpu;
     const string NAME;
     const uint32_t NUM_SET, NUM_WAY, NUM_LINE, WQ_SIZE, RQ_SIZE, PQ_SIZE, MSHR_SIZE;
+    const uint32_t LOG2_NUM_SET, SET_MASK; // precomputed so get_set() is a single AND
     uint32_t LATENCY;
     BLOCK **block;
     int fill_level;
@@ -90,12 +144,69 @@ class CACHE : public MEMORY {
     uint32_t reads_available_this_cycle;
     uint8_t cache_type;
 
+    // inclusion
+    uint8_t inclusion_policy,
+            writeback_clean_victims; // set on the caches above an exclusive level
+    uint64_t back_invalidations,
+             exclusive_victim_fills,
+             exclusive_promotions;
+
+    // coherence (shared address space only, NULL otherwise)
+    DIRECTORY *directory;
+    uint64_t coherence_misses,
+             coherence_miss_latency;
+
+    // LLC way partitioning (-llc_partition only, NULL otherwise)
+    UCP *partition;
+    uint64_t victim_mask; // ways the replacement policy may pick, all ones unless partitioned
+
+    // per-PC load profile of the data caches (-pc_profile only, NULL otherwise)
+    PC_PROFILER *pc_profile;
+
+    // stack distance profile of the blocks read from this cache (-reuse_profile only, off otherwise)
+    REUSE_PROFILER reuse_profile;
+
+    // replacement policy building blocks, left empty unless the policy initializes them
+    SET_DUELING set_dueling;
+    REPL_SAMPLER repl_sampler;
+
+    // replacement state of a REPL_* policy, allocated by initialize_replacement() (repl_state alone
+    // by allocate_repl_state() for the LLC policies)
+    uint8_t  repl_policy;
+    uint8_t  *repl_state;     // NUM_WAY bytes per set: LRU stack position (0 is MRU) or RRPV
+    uint64_t *plru_tree;      // one bit per tree node per set, pointing towards the victim
+    uint16_t *ship_signature; // NUM_WAY per set
+    uint8_t  *ship_reused,    // NUM_WAY per set
+             *shct;
+    uint32_t bip_counter;
+    uint64_t rand_state;
+
+    // state of the *.llc_repl policy of this cache, allocated by llc_initialize_replacement()
+    void *llc_repl_state;
+
+    // state of the *.l?_pref prefetcher of this cache, allocated by its initialize function
+    void *pf_state;
+
+    // prefetcher chain and its duplicate filter (NULL without a chain), see prefetcher.h
+    vector<PREFETCHER*> prefetchers;
+    uint64_t *pf_filter;
+
+    // prefetch throttling of the chain (-fdp only, off otherwise)
+    FDP fdp;
+
+    // prefetch timeliness of every prefetch seen by this cache, and of the prefetches issued by
+    // its *.l?_pref prefetcher (chain prefetchers keep their own)
+    PF_TIMELINESS pf_timeliness,
+                  pf_base_timeliness,
+                  *pf_issuer; // set by a chain prefetcher around its prefetch_line calls
+
     // prefetch stats
     uint64_t pf_requested,
              pf_issued,
              pf_useful,
              pf_useless,
-             pf_fill;
+             pf_fill,
+             pf_filtered;
 
     // queues
     PACKET_QUEUE WQ{NAME + "_WQ", WQ_SIZE}, // write queue
@@ -112,10 +223,12 @@ class CACHE : public MEMORY {
              roi_miss[NUM_CPUS][NUM_TYPES];
 
     uint64_t total_miss_latency;
+    LOG_HISTOGRAM mshr_residency; // region of interest only
     
     // constructor
     CACHE(string v1, uint32_t v2, int v3, uint32_t v4, uint32_t v5, uint32_t v6, uint32_t v7, uint32_t v8) 
-        : NAME(v1), NUM_SET(v2), NUM_WAY(v3), NUM_LINE(v4), WQ_SIZE(v5), RQ_SIZE(v6), PQ_SIZE(v7), MSHR_SIZE(v8) {
+        : NAME(v1), NUM_SET(v2), NUM_WAY(v3), NUM_LINE(v4), WQ_SIZE(v5), RQ_SIZE(v6), PQ_SIZE(v7), MSHR_SIZE(v8),
+          LOG2_NUM_SET(const_lg2(v2)), SET_MASK((1 << const_lg2(v2)) - 1) {
 
         LATENCY = 0;
 
@@ -156,6 +269,36 @@ class CACHE : public MEMORY {
         pf_useful = 0;
         pf_useless = 0;
         pf_fill = 0;
+        pf_filtered = 0;
+
+        pf_state = NULL;
+        pf_filter = NULL;
+        pf_issuer = NULL;
+
+        inclusion_policy = NON_INCLUSIVE;
+        writeback_clean_victims = 0;
+        back_invalidations = 0;
+        exclusive_victim_fills = 0;
+        exclusive_promotions = 0;
+
+        directory = NULL;
+        coherence_misses = 0;
+        coherence_miss_latency = 0;
+
+        partition = NULL;
+        victim_mask = ~0ull;
+
+        pc_profile = NULL;
+
+        repl_policy = REPL_LRU;
+        repl_state = NULL;
+        plru_tree = NULL;
+        ship_signature = NULL;
+        ship_reused = NULL;
+        shct = NULL;
+        bip_counter = 0;
+        rand_state = 0;
+        llc_repl_state = NULL;
     };
 
     // destructor
@@ -163,6 +306,13 @@ class CACHE : public MEMORY {
         for (uint32_t i=0; i<NUM_SET; i++)
             delete[] block[i];
         delete[] block;
+
+        delete[] repl_state;
+        delete[] plru_tree;
+        delete[] ship_signature;
+        delete[] ship_reused;
+        delete[] shct;
+        delete[] pf_filter;
     };
 
     // functions
@@ -177,35 +327,45 @@ class CACHE : public MEMORY {
     uint32_t get_occupancy(uint8_t queue_type, uint64_t address),
              get_size(uint8_t queue_type, uint64_t address);
 
+    uint8_t back_invalidate(uint64_t inval_addr),
+            filter_prefetch(uint64_t pf_addr); // 1 if pf_addr was issued recently
+    uint64_t effective_capacity();
+
     int  check_hit(PACKET *packet),
          invalidate_entry(uint64_t inval_addr),
          check_mshr(PACKET *packet),
          prefetch_line(uint64_t ip, uint64_t base_addr, uint64_t pf_addr, int prefetch_fill_level, uint32_t prefetch_metadata),
          kpc_prefetch_line(uint64_t base_addr, uint64_t pf_addr, int prefetch_fill_level, int delta, int depth, int signature, int confidence, uint32_t prefetch_metadata);
 
-    void handle_fill(),
-         handle_writeback(),
-         handle_read(),
-         handle_prefetch();
+    // per-level pipeline, instantiated once for every IS_* cache type
+    template <uint8_t LEVEL> void operate_level();
+    template <uint8_t LEVEL> void handle_fill();
+    template <uint8_t LEVEL> void handle_writeback();
+    template <uint8_t LEVEL> void handle_read();
+    template <uint8_t LEVEL> void handle_prefetch();
 
     void add_mshr(PACKET *packet),
          update_fill_cycle(),
+         initialize_replacement(),
+         allocate_repl_state(uint8_t value),
          llc_initialize_replacement(),
          update_replacement_state(uint32_t cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type, uint8_t hit),
          llc_update_replacement_state(uint32_t cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type, uint8_t hit),
          lru_update(uint32_t set, uint32_t way),
+         plru_update(uint32_t set, uint32_t way),
          fill_cache(uint32_t set, uint32_t way, PACKET *packet),
          replacement_final_stats(),
          llc_replacement_final_stats(),
-         //prefetcher_initialize(),
+         prefetcher_initialize(const uint8_t *chain, uint32_t length),
          l1d_prefetcher_initialize(),
          l2c_prefetcher_initialize(),
          llc_prefetcher_initialize(),
          prefetcher_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type),
          l1d_prefetcher_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type),
          prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr),
-         l1d_prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in),
-         //prefetcher_final_stats(),
+         l1d_prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in, uint64_t latency), // latency is 0 unless known
+         prefetcher_throttle(int32_t direction), // +1 more, -1 less aggressive
+         prefetcher_final_stats(),
          l1d_prefetcher_final_stats(),
          l2c_prefetcher_final_stats(),
          llc_prefetcher_final_stats();
@@ -217,11 +377,16 @@ class CACHE : public MEMORY {
          l2c_prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in),
          llc_prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in);
     
-    uint32_t get_set(uint64_t address),
-             get_way(uint64_t address, uint32_t set),
+    uint32_t get_set(uint64_t address) { return (uint32_t) (address & SET_MASK); }
+    uint8_t &rrpv(uint32_t set, uint32_t way) { return repl_state[set*NUM_WAY + way]; }
+
+    uint32_t get_way(uint64_t address, uint32_t set),
              find_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, const BLOCK *current_set, uint64_t ip, uint64_t full_addr, uint32_t type),
              llc_find_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, const BLOCK *current_set, uint64_t ip, uint64_t full_addr, uint32_t type),
-             lru_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, const BLOCK *current_set, uint64_t ip, uint64_t full_addr, uint32_t type);
+             llc_partition_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, uint64_t ip, uint64_t full_addr, uint32_t type),
+             lru_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, const BLOCK *current_set, uint64_t ip, uint64_t full_addr, uint32_t type),
+             plru_victim(uint32_t set),
+             rrip_victim(uint32_t set);
 };
 
 #endif
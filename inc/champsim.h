@@ -79,7 +79,17 @@ extern uint8_t warmup_complete[NUM_CPUS],
                all_simulation_complete,
                MAX_INSTR_DESTINATIONS,
                knob_cloudsuite,
-               knob_low_bandwidth;
+               knob_low_bandwidth,
+               knob_shared_address_space,
+               knob_llc_partition,
+               knob_pc_profile,
+               knob_fdp,
+               knob_btb,
+               knob_wrong_path,
+               knob_wrong_path_loads,
+               knob_uop_cache;
+
+extern uint32_t knob_reuse_profile;
 
 extern uint64_t current_core_cycle[NUM_CPUS], 
                 stall_cycle[NUM_CPUS], 
@@ -99,6 +109,9 @@ uint64_t rotl64 (uint64_t n, unsigned int c),
 // log base 2 function from efectiu
 int lg2(int n);
 
+// compile-time floor(log2(n)), matches lg2() for n >= 1
+constexpr int const_lg2(int n) { return (n > 1) ? 1 + const_lg2(n >> 1) : 0; }
+
 // smart random number generator
 class RANDOM {
   public:
@@ -0,0 +1,90 @@
+#ifndef DIRECTORY_H
+#define DIRECTORY_H
+
+#include "cache.h"
+
+// SPARSE DIRECTORY (sits next to the LLC, tracks the L1D/L2C copies of every core)
+#define DIR_SET (NUM_CPUS*1024)
+#define DIR_WAY 16  // 2x the total L2C capacity
+#define COHERENCE_LATENCY 30 // round trip to invalidate or downgrade a remote private cache
+
+#if NUM_CPUS > 64
+#error "the directory sharer vector only holds 64 cpus"
+#endif
+
+// directory state of a block (the private MESI state follows from it)
+#define DIR_UNCACHED  0
+#define DIR_SHARED    1 // S in every sharer
+#define DIR_EXCLUSIVE 2 // E or M in the owner, the owner may write silently
+
+class DIRECTORY_ENTRY {
+  public:
+    uint8_t valid,
+            state;
+
+    uint32_t owner,
+             lru;
+
+    uint64_t address,
+             sharers,
+             invalidated; // cores that lost their copy to another core's write
+
+    DIRECTORY_ENTRY() {
+        valid = 0;
+        state = DIR_UNCACHED;
+        owner = 0;
+        lru = 0;
+        address = 0;
+        sharers = 0;
+        invalidated = 0;
+    };
+};
+
+class DIRECTORY {
+  public:
+    const string NAME;
+    DIRECTORY_ENTRY entry[DIR_SET][DIR_WAY];
+
+    CACHE *L1D[NUM_CPUS], *L2C[NUM_CPUS], *LLC;
+
+    // stats
+    uint64_t lookup,
+             invalidation[NUM_CPUS],
+             downgrade[NUM_CPUS],
+             upgrade[NUM_CPUS],
+             recall,
+             coherence_writeback,
+             coherence_miss[NUM_CPUS];
+
+    // constructor
+    DIRECTORY(string v1) : NAME(v1) {
+        for (uint32_t i=0; i<DIR_SET; i++) {
+            for (uint32_t j=0; j<DIR_WAY; j++)
+                entry[i][j].lru = j;
+        }
+
+        for (uint32_t i=0; i<NUM_CPUS; i++) {
+            L1D[i] = NULL;
+            L2C[i] = NULL;
+        }
+        LLC = NULL;
+
+        reset_stats();
+    };
+
+    // functions
+    uint32_t handle_request(PACKET *packet);
+    uint8_t  is_owner(uint32_t cpu, uint64_t address),
+             write_back(uint32_t cpu, uint64_t address); // dirty data to the LLC, 0 if its WQ is full
+    void     reset_stats(),
+             print_stats();
+
+  private:
+    DIRECTORY_ENTRY *find_entry(uint64_t address),
+                    *allocate_entry(uint64_t address);
+    void     update_lru(uint32_t set, uint32_t way);
+    uint8_t  invalidate_copies(uint32_t cpu, uint64_t address, uint8_t &dirty),
+             downgrade_copies(uint32_t cpu, uint64_t address);
+};
+
+#endif
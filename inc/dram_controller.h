@@ -35,6 +35,10 @@ class MEMORY_CONTROLLER : public MEMORY {
 
     BANK_REQUEST bank_request[DRAM_CHANNELS][DRAM_RANKS][DRAM_BANKS];
 
+    // reads in the region of interest: waiting in the RQ, then from scheduling until the data is on the bus
+    LOG_HISTOGRAM read_queue_latency,
+                  read_service_latency;
+
     // queues
     PACKET_QUEUE WQ[DRAM_CHANNELS], RQ[DRAM_CHANNELS];
 
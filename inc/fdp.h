@@ -0,0 +1,73 @@
+#ifndef FDP_H
+#define FDP_H
+
+#include "champsim.h"
+
+// FEEDBACK DIRECTED PREFETCHING (Srinath et al., HPCA 2007, only used with -fdp)
+#define FDP_ACCURACY_HIGH 0.75
+#define FDP_ACCURACY_LOW  0.40
+#define FDP_LATENESS      0.01  // late / useful prefetches above which prefetches are late
+#define FDP_POLLUTION     0.005 // demand misses to prefetch victims / demand misses above which prefetches pollute
+#define FDP_BLOOM_BITS    4096  // blocks evicted by prefetches
+
+#if (FDP_BLOOM_BITS & (FDP_BLOOM_BITS - 1)) || (FDP_BLOOM_BITS < 64)
+#error "FDP_BLOOM_BITS must be a power of two of at least 64"
+#endif
+
+// samples accuracy, lateness and pollution of the prefetches of one cache every interval
+// (a number of fills) and decides whether the prefetchers should get more or less aggressive
+class FDP {
+  public:
+    uint32_t interval; // fills between two decisions, 0 while off
+
+    uint64_t bloom[FDP_BLOOM_BITS/64];
+
+    // this interval
+    uint64_t fills,
+             sent,
+             used,
+             late,
+             misses,
+             pollution;
+
+    // older intervals, each weighing half as much as the next
+    uint64_t avg_sent,
+             avg_used,
+             avg_late,
+             avg_misses,
+             avg_pollution;
+
+    // stats
+    uint64_t intervals,
+             increase,
+             decrease;
+
+    FDP() {
+        interval = 0;
+        init_state();
+        reset_stats();
+    };
+
+    void init(uint32_t fills_per_interval);
+    uint8_t enabled() { return interval != 0; }
+
+    // a demand hit on a prefetched block, or a demand merged into an in-flight prefetch
+    void prefetch_used() { used++; }
+    void prefetch_late() { late++; used++; sent++; }
+
+    // address and victim_addr are block addresses; fill returns +1 or -1 when the prefetchers
+    // should get more or less aggressive and 0 otherwise
+    void    demand_miss(uint64_t address);
+    int32_t fill(uint64_t address, uint8_t prefetch, uint8_t victim_valid, uint64_t victim_addr);
+
+    void reset_stats(),
+         print_stats(string name);
+
+  private:
+    void    init_state();
+    int32_t decide();
+
+    static uint32_t hash(uint64_t address) { return (uint32_t) ((address * 0x9E3779B97F4A7C15ull) >> 32) & (FDP_BLOOM_BITS - 1); }
+};
+
+#endif
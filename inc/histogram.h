@@ -0,0 +1,59 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "champsim.h"
+
+// LOG-LINEAR LATENCY HISTOGRAM (HDR style): every power of two is split into HISTOGRAM_SUB_BUCKETS
+// equal buckets, so values below 2*HISTOGRAM_SUB_BUCKETS are exact and larger ones are off by
+// at most 1/HISTOGRAM_SUB_BUCKETS
+#define HISTOGRAM_SUB_BUCKETS 16
+#define LOG2_HISTOGRAM_SUB_BUCKETS 4
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_BUCKETS * (64 - LOG2_HISTOGRAM_SUB_BUCKETS + 1))
+
+#if (1 << LOG2_HISTOGRAM_SUB_BUCKETS) != HISTOGRAM_SUB_BUCKETS
+#error "HISTOGRAM_SUB_BUCKETS must be 1 << LOG2_HISTOGRAM_SUB_BUCKETS"
+#endif
+
+class LOG_HISTOGRAM {
+  public:
+    uint64_t count,
+             sum,
+             max,
+             bucket[HISTOGRAM_BUCKETS];
+
+    LOG_HISTOGRAM() {
+        reset();
+    };
+
+    void add(uint64_t value) {
+        bucket[index(value)]++;
+        count++;
+        sum += value;
+        if (value > max)
+            max = value;
+    }
+
+    void     reset(),
+             print(string name);
+    uint64_t percentile(double p); // upper bound of the bucket holding the p-th percentile
+
+  private:
+    static uint32_t index(uint64_t value) {
+        if (value < HISTOGRAM_SUB_BUCKETS)
+            return value;
+
+        // the leading bit picks the power of two, the next bits the bucket within it
+        uint32_t msb = 63 - __builtin_clzll(value);
+        return ((msb - LOG2_HISTOGRAM_SUB_BUCKETS + 1) << LOG2_HISTOGRAM_SUB_BUCKETS) + ((value >> (msb - LOG2_HISTOGRAM_SUB_BUCKETS)) & (HISTOGRAM_SUB_BUCKETS - 1));
+    }
+
+    static uint64_t floor(uint32_t index) {
+        if (index < HISTOGRAM_SUB_BUCKETS)
+            return index;
+
+        uint32_t octave = (index >> LOG2_HISTOGRAM_SUB_BUCKETS) - 1;
+        return ((uint64_t) (HISTOGRAM_SUB_BUCKETS + (index & (HISTOGRAM_SUB_BUCKETS - 1)))) << octave;
+    }
+};
+
+#endif
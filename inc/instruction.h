@@ -25,6 +25,11 @@
 #define BRANCH_RETURN        6
 #define BRANCH_OTHER         7
 
+// how fetch finds out it went the wrong way after a branch
+#define REDIRECT_NONE    0
+#define REDIRECT_DECODE  1 // the BTB missed a taken branch, decode finds it (only with -btb)
+#define REDIRECT_EXECUTE 2 // wrong direction or target, the branch has to execute
+
 #include "set.h"
 
 class input_instr {
@@ -115,6 +120,9 @@ class ooo_model_instr {
             branch_taken,
             branch_mispredicted,
             branch_prediction_made,
+            branch_prediction,
+            branch_redirect,
+            uop_cache_hit, // delivered by the uop cache, without fetch or decode (only with -uop_cache)
             translated,
             data_translated,
             source_added[NUM_INSTR_SOURCES],
@@ -185,6 +193,9 @@ class ooo_model_instr {
         branch_taken = 0;
         branch_mispredicted = 0;
 	branch_prediction_made = 0;
+	branch_prediction = 0;
+        branch_redirect = REDIRECT_NONE;
+        uop_cache_hit = 0;
         translated = 0;
         data_translated = 0;
         is_producer = 0;
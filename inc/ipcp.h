@@ -0,0 +1,39 @@
+#ifndef IPCP_H
+#define IPCP_H
+
+#include "cache.h"
+
+// IPCP: INSTRUCTION POINTER CLASSIFIER BASED PREFETCHING (Pakalapati and Panda, ISCA 2020)
+// the L1D classifies the load IPs, and every L1D prefetch that leaves for the L2C carries the
+// class and the stride of its IP in pf_metadata, so the L2C can keep prefetching ahead of it
+
+// IP classes, in the order the L1D picks them
+#define IPCP_NONE 0
+#define IPCP_GS   1 // global stream (the IP walks a dense region)
+#define IPCP_CS   2 // constant stride
+#define IPCP_CPLX 3 // complex stride (repeating sequence of strides)
+#define IPCP_NL   4 // next line, while the L1D MSHR is not busy
+#define IPCP_CLASSES 5
+
+// pf_metadata: bits 0-3 magic, 4-6 class, 8-15 stride (the direction for IPCP_GS)
+#define IPCP_MAGIC 0xA
+
+inline uint32_t ipcp_encode(uint32_t ip_class, int32_t stride)
+{
+    return IPCP_MAGIC | (ip_class << 4) | (((uint32_t) stride & 0xFF) << 8);
+}
+
+inline uint32_t ipcp_class(uint32_t metadata)
+{
+    if ((metadata & 0xF) != IPCP_MAGIC)
+        return IPCP_NONE;
+
+    return (metadata >> 4) & 0x7;
+}
+
+inline int32_t ipcp_stride(uint32_t metadata)
+{
+    return (int8_t) ((metadata >> 8) & 0xFF);
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "champsim.h"
 #include "block.h"
+#include "histogram.h"
 
 // CACHE ACCESS TYPE
 #define LOAD      0
@@ -52,6 +53,7 @@ class MEMORY {
 class BANK_REQUEST {
   public:
     uint64_t cycle_available,
+             cycle_scheduled,
              address,
              full_addr;
 
@@ -68,6 +70,7 @@ class BANK_REQUEST {
 
     BANK_REQUEST() {
         cycle_available = 0;
+        cycle_scheduled = 0;
         address = 0;
         full_addr = 0;
 
@@ -2,6 +2,10 @@
 #define OOO_CPU_H
 
 #include "cache.h"
+#include "btb.h"
+#include "wrong_path.h"
+#include "uop_cache.h"
+#include "trace_reader.h"
 
 #ifdef CRC2_COMPILE
 #define STAT_PRINTING_PERIOD 1000000
@@ -21,12 +25,38 @@ using namespace std;
 #define RETIRE_WIDTH 4
 #define SCHEDULER_SIZE 128
 #define BRANCH_MISPREDICT_PENALTY 1
+#define BTB_MISS_PENALTY 2 // cycles after decode finds a taken branch the BTB missed (-btb)
 //#define SCHEDULING_LATENCY 0
 //#define EXEC_LATENCY 0
 //#define DECODE_LATENCY 2
 
 #define STA_SIZE (ROB_SIZE*NUM_INSTR_DESTINATIONS_SPARC)
 
+// FETCH TARGET QUEUE (decoupled front end)
+// stores are added to the STA when the branch predictor reads them, so the FTQ and the ROB
+// together must not hold more stores than the STA
+#define FTQ_SIZE 32 // fetch blocks predicted ahead of fetch
+#define FTQ_BLOCK_SIZE 8 // instructions, a block also ends at a branch predicted taken or mispredicted
+
+// the instructions from start_ip to end_ip, which are contiguous since every branch inside
+// was correctly predicted not taken (after warmup)
+class FTQ_ENTRY {
+  public:
+    uint64_t start_ip,
+             end_ip;
+    uint32_t num_instrs,
+             fetched,
+             pf_lines; // code lines of the block the L1I prefetcher is done with
+
+    FTQ_ENTRY() {
+        start_ip = 0;
+        end_ip = 0;
+        num_instrs = 0;
+        fetched = 0;
+        pf_lines = 0;
+    };
+};
+
 extern uint32_t SCHEDULING_LATENCY, EXEC_LATENCY, DECODE_LATENCY;
 
 // cpu
@@ -35,14 +65,9 @@ class O3_CPU {
     uint32_t cpu;
 
     // trace
-    FILE *trace_file;
-    char trace_string[1024];
-    char gunzip_command[1024];
+    TRACE_READER trace;
 
     // instruction
-    input_instr next_instr;
-    input_instr current_instr;
-    cloudsuite_instr current_cloudsuite_instr;
     uint64_t instr_unique_id, completed_executions, 
              begin_sim_cycle, begin_sim_instr, 
              last_sim_cycle, last_sim_instr,
@@ -73,6 +98,11 @@ class O3_CPU {
     uint32_t RTS0[SQ_SIZE], RTS0_head, RTS0_tail,
              RTS1[SQ_SIZE], RTS1_head, RTS1_tail;
 
+    // fetch blocks the branch predictor has run ahead to, and their instructions
+    deque<FTQ_ENTRY> FTQ;
+    deque<ooo_model_instr> FTQ_INSTR;
+    uint8_t bpu_stall; // a mispredicted branch is in the FTQ, so the rest of the path is unknown
+
     // branch
     int branch_mispredict_stall_fetch; // flag that says that we should stall because a branch prediction was wrong
     int mispredicted_branch_iw_index; // index in the instruction window of the mispredicted branch.  fetch resumes after the instruction at this index executes
@@ -80,8 +110,13 @@ class O3_CPU {
     uint64_t fetch_resume_cycle;
     uint64_t num_branch, branch_mispredictions;
     uint64_t total_rob_occupancy_at_branch_mispredict;
+    TARGET_PREDICTOR btb; // only used with -btb, otherwise the targets come from the trace
+    WRONG_PATH wrong_path; // only used with -wrong_path
   uint64_t total_branch_types[8];
 
+    // demand load latency, from issue to the L1D until the data is back
+    LOG_HISTOGRAM load_latency;
+
     // TLBs and caches
     CACHE ITLB{"ITLB", ITLB_SET, ITLB_WAY, ITLB_SET*ITLB_WAY, ITLB_WQ_SIZE, ITLB_RQ_SIZE, ITLB_PQ_SIZE, ITLB_MSHR_SIZE},
           DTLB{"DTLB", DTLB_SET, DTLB_WAY, DTLB_SET*DTLB_WAY, DTLB_WQ_SIZE, DTLB_RQ_SIZE, DTLB_PQ_SIZE, DTLB_MSHR_SIZE},
@@ -90,15 +125,13 @@ class O3_CPU {
           L1D{"L1D", L1D_SET, L1D_WAY, L1D_SET*L1D_WAY, L1D_WQ_SIZE, L1D_RQ_SIZE, L1D_PQ_SIZE, L1D_MSHR_SIZE},
           L2C{"L2C", L2C_SET, L2C_WAY, L2C_SET*L2C_WAY, L2C_WQ_SIZE, L2C_RQ_SIZE, L2C_PQ_SIZE, L2C_MSHR_SIZE};
 
-  // trace cache for previously decoded instructions
-  
+    // trace cache for previously decoded instructions
+    UOP_CACHE uop_cache; // only used with -uop_cache
+
     // constructor
     O3_CPU() {
         cpu = 0;
 
-        // trace
-        trace_file = NULL;
-
         // instruction
         instr_unique_id = 0;
         completed_executions = 0;
@@ -122,6 +155,8 @@ class O3_CPU {
 
         next_ITLB_fetch = 0;
 
+        bpu_stall = 0;
+
         // branch
         branch_mispredict_stall_fetch = 0;
         mispredicted_branch_iw_index = 0;
@@ -168,8 +203,10 @@ class O3_CPU {
     }
 
     // functions
-    void read_from_trace(),
+    void predict_fetch_block(),
+         read_from_trace(),
          fetch_instruction(),
+         fetch_wrong_path(),
          decode_and_dispatch(),
          schedule_instruction(),
          execute_instruction(),
@@ -204,6 +241,7 @@ class O3_CPU {
     uint32_t  add_to_rob(ooo_model_instr *arch_instr),
               check_rob(uint64_t instr_id);
 
+    uint8_t  decode_trace_instr(ooo_model_instr *arch_instr);
     uint32_t add_to_ifetch_buffer(ooo_model_instr *arch_instr);
     uint32_t add_to_decode_buffer(ooo_model_instr *arch_instr);
 
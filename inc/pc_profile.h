@@ -0,0 +1,68 @@
+#ifndef PC_PROFILE_H
+#define PC_PROFILE_H
+
+#include "cache.h"
+
+// PER-PC LOAD PROFILE (only used with -pc_profile)
+#define PC_PROFILE_SIZE 4096 // table entries per cpu, a power of two
+#define PC_PROFILE_MAX_OCCUPANCY (PC_PROFILE_SIZE - PC_PROFILE_SIZE/8) // keeps probe sequences short
+#define PC_PROFILE_TOP 20 // PCs reported per cpu
+#define PC_PROFILE_LEVELS 3 // L1D, L2C and LLC
+
+#if (PC_PROFILE_SIZE & (PC_PROFILE_SIZE - 1))
+#error "PC_PROFILE_SIZE must be a power of two"
+#endif
+
+// data loads of one PC, an ip of 0 marks an empty slot
+class PC_PROFILE_ENTRY {
+  public:
+    uint64_t ip,
+             access,                   // L1D accesses
+             miss[PC_PROFILE_LEVELS],  // misses at every level
+             miss_latency,             // summed L1D miss latency, the stall this PC causes
+             pf_hit,                   // hits on a prefetched block, at any level
+             pf_late;                  // misses merged into an in-flight prefetch
+
+    PC_PROFILE_ENTRY() {
+        clear();
+    };
+
+    void clear() {
+        ip = 0;
+        access = 0;
+        for (uint32_t i=0; i<PC_PROFILE_LEVELS; i++)
+            miss[i] = 0;
+        miss_latency = 0;
+        pf_hit = 0;
+        pf_late = 0;
+    }
+};
+
+class PC_PROFILER {
+  public:
+    const string NAME;
+
+    // open addressing with linear probing
+    PC_PROFILE_ENTRY table[NUM_CPUS][PC_PROFILE_SIZE];
+    uint32_t occupancy[NUM_CPUS];
+
+    // accesses of PCs that found the table full
+    uint64_t untracked[NUM_CPUS];
+
+    // constructor
+    PC_PROFILER(string v1) : NAME(v1) {
+        reset_stats();
+    };
+
+    // functions, called by the caches for data loads only (level is the cache_type)
+    void access(uint32_t cpu, uint8_t level, uint64_t ip, uint8_t hit, uint8_t prefetched),
+         late_prefetch(uint32_t cpu, uint8_t level, uint64_t ip),
+         fill(uint32_t cpu, uint8_t level, uint64_t ip, uint64_t latency),
+         reset_stats(),
+         print_stats();
+
+  private:
+    PC_PROFILE_ENTRY *find(uint32_t cpu, uint64_t ip);
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef PF_TIMELINESS_H
+#define PF_TIMELINESS_H
+
+#include "histogram.h"
+
+// what became of the prefetches of one cache or one prefetcher (region of interest only)
+class PF_TIMELINESS {
+  public:
+    uint64_t issued,     // queued by prefetch_line
+             timely,     // a demand hit the prefetched block
+             late,       // a demand merged into the prefetch while it was still in flight
+             dropped,    // the PQ was full
+             redundant,  // the block was already in the cache
+             useless,    // evicted before any demand hit it
+             cross_page; // the prefetch address was in another page
+
+    LOG_HISTOGRAM earliness; // cycles from the fill of a timely prefetch to its first demand hit
+
+    PF_TIMELINESS() {
+        reset();
+    };
+
+    void reset(),
+         print(string name);
+};
+
+#endif
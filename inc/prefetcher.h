@@ -0,0 +1,120 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include "cache.h"
+
+// aggressiveness levels of the throttle API, the middle one is the configured degree and distance
+#define PF_AGGRESSIVENESS_LEVELS 5
+#define PF_DEFAULT_AGGRESSIVENESS 2
+
+// built-in prefetcher of a prefetcher chain: the cache runs the prefetcher built from
+// prefetcher/*.l?_pref first and then every prefetcher of its chain, in order
+class PREFETCHER {
+  public:
+    const string NAME;
+    CACHE *cache;
+
+    // how many blocks to prefetch and how far ahead of the access the first one is
+    uint32_t degree,
+             distance;
+
+    // throttling (-fdp): the level picks degree and distance around their configured values
+    const uint32_t base_degree,
+                   base_distance;
+    uint32_t aggressiveness;
+
+    // stats
+    PF_TIMELINESS timeliness;
+
+    PREFETCHER(string v1, CACHE *v2, uint32_t v3, uint32_t v4) : NAME(v1), cache(v2), degree(v3), distance(v4), base_degree(v3), base_distance(v4) {
+        aggressiveness = PF_DEFAULT_AGGRESSIVENESS;
+    };
+
+    virtual ~PREFETCHER() {};
+
+    // addr and ip as seen by the cache's own prefetcher, type is LOAD or PREFETCH
+    virtual void operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type) = 0;
+    virtual void cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr) {};
+    virtual void final_stats();
+
+    // level is below PF_AGGRESSIVENESS_LEVELS; every level away from the default doubles or halves
+    // degree and distance, a prefetcher with other knobs overrides this
+    virtual void throttle(uint32_t level);
+
+  protected:
+    // prefetch into this cache, or into the next level when more than half of the MSHRs are busy
+    int issue(uint64_t ip, uint64_t base_addr, uint64_t pf_addr);
+};
+
+// the next degree blocks, starting distance blocks after the access
+class NEXT_LINE_PREFETCHER : public PREFETCHER {
+  public:
+    NEXT_LINE_PREFETCHER(CACHE *v1) : PREFETCHER("next_line", v1, 1, 1) {};
+
+    void operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type);
+};
+
+// PC-based stride (the ip_stride.l2c_pref algorithm, with state of its own)
+#define STRIDE_TRACKERS 1024
+
+class STRIDE_TRACKER {
+  public:
+    uint64_t ip,
+             last_cl_addr;
+    int64_t  last_stride;
+    uint32_t lru;
+
+    STRIDE_TRACKER() {
+        ip = 0;
+        last_cl_addr = 0;
+        last_stride = 0;
+        lru = 0;
+    };
+};
+
+class IP_STRIDE_PREFETCHER : public PREFETCHER {
+  public:
+    STRIDE_TRACKER trackers[STRIDE_TRACKERS];
+
+    IP_STRIDE_PREFETCHER(CACHE *v1) : PREFETCHER("ip_stride", v1, 3, 1) {
+        for (uint32_t i=0; i<STRIDE_TRACKERS; i++)
+            trackers[i].lru = i;
+    };
+
+    void operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type);
+};
+
+// sequential streams within a page, in either direction
+#define STREAM_TRACKERS 32
+#define STREAM_CONFIDENCE 2 // same-direction accesses before a stream is prefetched
+
+class STREAM_TRACKER {
+  public:
+    uint64_t page;
+    int32_t  last_offset,
+             direction;
+    uint32_t confidence,
+             lru;
+
+    STREAM_TRACKER() {
+        page = 0;
+        last_offset = 0;
+        direction = 0;
+        confidence = 0;
+        lru = 0;
+    };
+};
+
+class STREAM_PREFETCHER : public PREFETCHER {
+  public:
+    STREAM_TRACKER trackers[STREAM_TRACKERS];
+
+    STREAM_PREFETCHER(CACHE *v1) : PREFETCHER("stream", v1, 4, 2) {
+        for (uint32_t i=0; i<STREAM_TRACKERS; i++)
+            trackers[i].lru = i;
+    };
+
+    void operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type);
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef REUSE_PROFILE_H
+#define REUSE_PROFILE_H
+
+#include "champsim.h"
+
+#include <unordered_map>
+#include <vector>
+
+// LRU STACK DISTANCE PROFILE (only used with -reuse_profile)
+#define REUSE_SUB_BUCKETS 4 // histogram buckets per power of two, so non power-of-two sizes (e.g. 12 ways) line up
+#define REUSE_BUCKETS (REUSE_SUB_BUCKETS * 40)
+#define REUSE_INITIAL_SIZE 65536 // initial timestamps in the Fenwick tree, doubled when it fills with live blocks
+#define REUSE_MRC_RANGE 16 // the miss ratio curve spans cache sizes from 1/16 to 16 times the profiled cache
+#define REUSE_MAX_SAMPLE_RATE 65536 // -reuse_profile N tracks 1/N of the blocks, at least this fraction
+
+// stack distance of an access = distinct blocks touched since the last access to the same block,
+// counted with a Fenwick tree that holds a 1 at the last access time of every block
+// (a fully associative LRU cache of C blocks hits exactly when the distance is below C)
+class REUSE_PROFILER {
+  public:
+    // SHARDS (Waldspurger et al., FAST 2015): only blocks whose hash falls in 1/sample_rate of the
+    // hash space are tracked, and their distances are scaled up by sample_rate
+    uint32_t sample_rate; // 0 while the profiler is off, 1 for exact distances
+
+    uint64_t now, // next timestamp
+             size;
+    vector<uint32_t> tree;
+    unordered_map<uint64_t, uint64_t> last_access;
+
+    // stats (sampled accesses only)
+    uint64_t access,
+             cold,
+             histogram[REUSE_BUCKETS];
+
+    REUSE_PROFILER() {
+        sample_rate = 0;
+        now = 0;
+        size = 0;
+        reset_stats();
+    };
+
+    void init(uint32_t rate);
+    uint8_t enabled() { return sample_rate != 0; }
+
+    // address is a block address; record is 0 during warmup, when only the stack gets updated
+    void access_block(uint64_t address, uint8_t record),
+         reset_stats(),
+         print_stats(string name, uint32_t num_line);
+
+  private:
+    void     mark(uint64_t time, int32_t delta),
+             compact();
+    uint64_t count(uint64_t time); // marks at timestamps up to and including time
+
+    static uint32_t bucket(uint64_t distance);
+    static uint64_t bucket_floor(uint32_t bucket);
+};
+
+#endif
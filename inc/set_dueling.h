@@ -0,0 +1,133 @@
+#ifndef SET_DUELING_H
+#define SET_DUELING_H
+
+#include "champsim.h"
+
+// building blocks for replacement policies: every CACHE owns one of each, and a policy
+// sets up the ones it needs in its initialize function
+
+// LEADER SET SELECTION
+#define LEADER_RANDOM  0 // pseudo-random sets (the generator the original DRRIP/SHiP code used)
+#define LEADER_STRIDED 1 // evenly spaced sets, a different offset for every cpu and policy
+
+// fills sets[] with count distinct set indices
+void select_sets(uint8_t selection, uint32_t num_set, uint32_t count, uint32_t *sets);
+
+// set dueling between two policies, one PSEL counter per cpu
+class SET_DUELING {
+  public:
+    uint32_t num_set,
+             leader_sets, // per cpu and policy
+             psel_max,
+             psel[NUM_CPUS];
+
+    // leader_policy[set] is 0 or 1 for the leaders of cpu leader_cpu[set], -1 otherwise
+    int8_t  *leader_policy;
+    uint8_t *leader_cpu;
+
+    SET_DUELING() {
+        num_set = 0;
+        leader_sets = 0;
+        psel_max = 0;
+        leader_policy = NULL;
+        leader_cpu = NULL;
+
+        for (uint32_t i=0; i<NUM_CPUS; i++)
+            psel[i] = 0;
+    };
+
+    ~SET_DUELING() {
+        delete[] leader_policy;
+        delete[] leader_cpu;
+    };
+
+    // a private cache duels for its own cpu only, with num_cpus = 1 and cpu 0
+    void init(uint32_t v1, uint32_t v2, uint32_t psel_width, uint8_t selection, uint32_t num_cpus = NUM_CPUS);
+
+    // -1 for a follower of this cpu
+    int leader(uint32_t cpu, uint32_t set) {
+        return ((leader_policy[set] >= 0) && (leader_cpu[set] == cpu)) ? leader_policy[set] : -1;
+    }
+
+    // a miss in a leader set votes against the policy of that leader
+    void miss(uint32_t cpu, uint32_t set) {
+        int policy = leader(cpu, set);
+        if ((policy == 0) && (psel[cpu] > 0))
+            psel[cpu]--;
+        else if ((policy == 1) && (psel[cpu] < psel_max))
+            psel[cpu]++;
+    }
+
+    // policy of a leader set, or the policy currently winning for a follower
+    uint32_t policy(uint32_t cpu, uint32_t set) {
+        int l = leader(cpu, set);
+        if (l >= 0)
+            return l;
+
+        return (psel[cpu] > psel_max/2) ? 0 : 1;
+    }
+};
+
+// SAMPLED AUXILIARY TAG DIRECTORY
+class SAMPLER_ENTRY {
+  public:
+    uint8_t valid,
+            type,
+            used; // hit since it was inserted
+
+    uint32_t cpu,
+             lru;
+
+    uint64_t address, // block address
+             ip;
+
+    SAMPLER_ENTRY() {
+        valid = 0;
+        type = 0;
+        used = 0;
+        cpu = 0;
+        lru = 0;
+        address = 0;
+        ip = 0;
+    };
+};
+
+// a few sets of the cache shadowed with LRU tags, telling the policy which lines got reused and which died
+class REPL_SAMPLER {
+  public:
+    uint32_t num_set,
+             num_sampled,
+             num_way;
+
+    int32_t *sampled; // sampler set of every cache set, -1 if it is not sampled
+    SAMPLER_ENTRY *entry;
+
+    // called before the sampler updates the entry; cpu is the cpu making the access
+    void (*observe_hit)(uint32_t cpu, const SAMPLER_ENTRY &hit);
+    void (*observe_evict)(uint32_t cpu, const SAMPLER_ENTRY &victim);
+
+    REPL_SAMPLER() {
+        num_set = 0;
+        num_sampled = 0;
+        num_way = 0;
+        sampled = NULL;
+        entry = NULL;
+        observe_hit = NULL;
+        observe_evict = NULL;
+    };
+
+    ~REPL_SAMPLER() {
+        delete[] sampled;
+        delete[] entry;
+    };
+
+    void init(uint32_t v1, uint32_t v2, uint32_t v3, uint8_t selection);
+
+    uint8_t is_sampled(uint32_t set) { return sampled && (sampled[set] >= 0); }
+
+    // hit: observe_hit, mark the entry used (the ip of the inserting access is kept)
+    // miss: observe_evict on a valid LRU victim, then insert
+    void access(uint32_t cpu, uint32_t set, uint64_t full_addr, uint64_t ip, uint8_t type);
+};
+
+#endif
@@ -48,6 +48,8 @@
 enum FILTER_REQUEST {SPP_L2C_PREFETCH, SPP_LLC_PREFETCH, L2C_DEMAND, L2C_EVICT}; // Request type for prefetch filter
 uint64_t get_hash(uint64_t key);
 
+class GLOBAL_REGISTER;
+
 class SIGNATURE_TABLE {
   public:
     bool     valid[ST_SET][ST_WAY];
@@ -73,7 +75,7 @@ class SIGNATURE_TABLE {
             }
     };
 
-    void read_and_update_sig(uint64_t page, uint32_t page_offset, uint32_t &last_sig, uint32_t &curr_sig, int32_t &delta);
+    void read_and_update_sig(uint64_t page, uint32_t page_offset, uint32_t &last_sig, uint32_t &curr_sig, int32_t &delta, GLOBAL_REGISTER &GHR);
 };
 
 class PATTERN_TABLE {
@@ -100,7 +102,7 @@ class PATTERN_TABLE {
     }
 
     void update_pattern(uint32_t last_sig, int curr_delta),
-         read_pattern(uint32_t curr_sig, int *prefetch_delta, uint32_t *confidence_q, uint32_t &lookahead_way, uint32_t &lookahead_conf, uint32_t &pf_q_tail, uint32_t &depth);
+         read_pattern(uint32_t curr_sig, int *prefetch_delta, uint32_t *confidence_q, uint32_t &lookahead_way, uint32_t &lookahead_conf, uint32_t &pf_q_tail, uint32_t &depth, GLOBAL_REGISTER &GHR);
 };
 
 class PREFETCH_FILTER {
@@ -121,7 +123,7 @@ class PREFETCH_FILTER {
 
     }
 
-    bool     check(uint64_t pf_addr, FILTER_REQUEST filter_request);
+    bool     check(uint64_t pf_addr, FILTER_REQUEST filter_request, GLOBAL_REGISTER &GHR);
 };
 
 class GLOBAL_REGISTER {
@@ -156,4 +158,13 @@ class GLOBAL_REGISTER {
     uint32_t check_entry(uint32_t page_offset);
 };
 
+// everything SPP learns, one per L2C (allocated in one piece by l2c_prefetcher_initialize)
+class SPP_STATE {
+  public:
+    SIGNATURE_TABLE ST;
+    PATTERN_TABLE   PT;
+    PREFETCH_FILTER FILTER;
+    GLOBAL_REGISTER GHR;
+};
+
 #endif
@@ -0,0 +1,40 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include "champsim.h"
+#include "instruction.h"
+
+// reads a compressed (gz or xz) champsim or cloudsuite trace, and decodes its instructions into
+// the performance model's format, classifying the branches; the trace starts over at its end
+class TRACE_READER {
+  public:
+    uint32_t cpu;
+    uint8_t  cloudsuite;
+
+    FILE *trace_file;
+    char trace_string[1024];
+    char gunzip_command[1024];
+
+    // one instruction of lookahead gives the targets of the taken branches
+    input_instr next_instr;
+    input_instr current_instr;
+    cloudsuite_instr current_cloudsuite_instr;
+    uint64_t num_read;
+
+    TRACE_READER() {
+        cpu = 0;
+        cloudsuite = 0;
+        trace_file = NULL;
+        trace_string[0] = '\0';
+        gunzip_command[0] = '\0';
+        num_read = 0;
+    };
+
+    void open(uint32_t trace_cpu, const char *trace_name, uint8_t cloudsuite_trace);
+
+    // returns 0 instead of an instruction when the trace reaches its end and starts over;
+    // instr_id is left to the caller
+    uint8_t read(ooo_model_instr *decoded_instr);
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef UCP_H
+#define UCP_H
+
+#include "cache.h"
+
+// UTILITY-BASED CACHE PARTITIONING (way partitioning of the LLC, only used with -llc_partition)
+#define UMON_SET 32 // sampled LLC sets in every utility monitor
+#define UMON_STRIDE (LLC_SET/UMON_SET)
+#define UCP_EPOCH 5000000 // cycles between two repartitions
+
+#if NUM_CPUS > LLC_WAY
+#error "every cpu needs at least one LLC way"
+#endif
+
+#if LLC_WAY > 64
+#error "the victim mask only holds 64 ways"
+#endif
+
+// shadow tag of the utility monitor, kept in LRU order
+class UMON_ENTRY {
+  public:
+    uint8_t valid;
+    uint32_t lru;
+    uint64_t address;
+
+    UMON_ENTRY() {
+        valid = 0;
+        lru = 0;
+        address = 0;
+    };
+};
+
+class UCP {
+  public:
+    const string NAME;
+
+    // utility monitor: shadow tags that see the whole LLC, and the hits at every LRU stack position
+    UMON_ENTRY atd[NUM_CPUS][UMON_SET][LLC_WAY];
+    uint64_t way_hit[NUM_CPUS][LLC_WAY],
+             next_repartition;
+
+    uint32_t allocation[NUM_CPUS];
+
+    // stats
+    uint64_t repartition,
+             umon_access[NUM_CPUS],
+             umon_hit[NUM_CPUS],
+             allocated_ways[NUM_CPUS],
+             victim_override;
+
+    // constructor
+    UCP(string v1) : NAME(v1) {
+        for (uint32_t i=0; i<NUM_CPUS; i++) {
+            for (uint32_t j=0; j<UMON_SET; j++) {
+                for (uint32_t k=0; k<LLC_WAY; k++)
+                    atd[i][j][k].lru = k;
+            }
+
+            for (uint32_t k=0; k<LLC_WAY; k++)
+                way_hit[i][k] = 0;
+
+            // start from an even split
+            allocation[i] = LLC_WAY / NUM_CPUS;
+        }
+        for (uint32_t i=0; i<(LLC_WAY % NUM_CPUS); i++)
+            allocation[i]++;
+
+        next_repartition = UCP_EPOCH;
+
+        reset_stats();
+    };
+
+    // functions
+    void     observe(uint32_t cpu, uint64_t address),
+             operate(uint64_t cycle),
+             reset_stats(),
+             print_stats();
+    uint64_t victim_mask(uint32_t cpu, const BLOCK *current_set);
+
+  private:
+    void     lookahead();
+};
+
+#endif
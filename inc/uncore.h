@@ -3,6 +3,9 @@
 
 #include "champsim.h"
 #include "cache.h"
+#include "directory.h"
+#include "ucp.h"
+#include "pc_profile.h"
 #include "dram_controller.h"
 //#include "drc_controller.h"
 
@@ -15,6 +18,15 @@ class UNCORE {
     // LLC
     CACHE LLC{"LLC", LLC_SET, LLC_WAY, LLC_SET*LLC_WAY, LLC_WQ_SIZE, LLC_RQ_SIZE, LLC_PQ_SIZE, LLC_MSHR_SIZE};
 
+    // coherence directory (only used with -shared_address_space)
+    DIRECTORY directory{"DIR"};
+
+    // utility-based LLC way partitioning (only used with -llc_partition)
+    UCP partition{"UCP"};
+
+    // per-PC load profile of every cpu (only used with -pc_profile)
+    PC_PROFILER pc_profile{"PC_PROFILE"};
+
     // DRAM
     MEMORY_CONTROLLER DRAM{"DRAM"}; 
 
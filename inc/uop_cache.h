@@ -0,0 +1,74 @@
+#ifndef UOP_CACHE_H
+#define UOP_CACHE_H
+
+#include "champsim.h"
+
+// UOP CACHE (only used with -uop_cache)
+#define UOP_CACHE_SET 64
+#define UOP_CACHE_WAY 8
+#define LOG2_UOP_CACHE_WINDOW 5 // 32-byte fetch windows, one per entry
+#define UOP_CACHE_WINDOW_UOPS 18 // decoded instructions an entry holds at most
+#define UOP_CACHE_WIDTH 8 // instructions delivered per cycle on hits
+#define UOP_CACHE_SWITCH_PENALTY 1 // cycles lost, after the rest of the current one, when delivery switches to or from the legacy decoders
+
+#if (UOP_CACHE_SET & (UOP_CACHE_SET - 1))
+#error "UOP_CACHE_SET must be a power of two"
+#endif
+
+#if (LOG2_UOP_CACHE_WINDOW > 5)
+#error "the instruction offsets of a window must fit in 32 bits"
+#endif
+
+class UOP_CACHE_ENTRY {
+  public:
+    uint8_t  valid;
+    uint64_t window; // ip >> LOG2_UOP_CACHE_WINDOW
+    uint32_t offsets, // one bit per byte offset of the window an instruction starts at
+             lru;
+
+    UOP_CACHE_ENTRY() {
+        valid = 0;
+        window = 0;
+        offsets = 0;
+        lru = 0;
+    };
+};
+
+// the decoded instructions of recently fetched windows: a hit skips the L1I and the decode
+// latency, and delivers up to UOP_CACHE_WIDTH instructions a cycle instead of DECODE_WIDTH
+class UOP_CACHE {
+  public:
+    UOP_CACHE_ENTRY block[UOP_CACHE_SET][UOP_CACHE_WAY];
+
+    // the source instructions are delivered from, and when it can deliver again after a switch
+    uint8_t  delivering_hits;
+    uint64_t switch_resume_cycle;
+
+    // stats
+    uint64_t accesses,
+             hits,
+             fills,
+             switches,
+             switch_cycles;
+
+    UOP_CACHE();
+
+    // lookup counts in the stats and updates the LRU, probe does not
+    uint8_t probe(uint64_t ip),
+            lookup(uint64_t ip);
+    // the legacy decoders decoded the instruction at ip
+    void    fill(uint64_t ip);
+
+    // whether the instruction at the head of the IFETCH_BUFFER can be delivered this cycle,
+    // once its source is done switching
+    uint8_t deliver(uint8_t hit, uint64_t cycle);
+
+    void reset_stats();
+    void print_stats(uint32_t cpu);
+
+  private:
+    int  find(uint64_t ip);
+    void update_lru(uint32_t set, uint32_t way);
+};
+
+#endif
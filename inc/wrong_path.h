@@ -0,0 +1,93 @@
+#ifndef WRONG_PATH_H
+#define WRONG_PATH_H
+
+#include "champsim.h"
+#include "instruction.h"
+
+// WRONG-PATH FETCH (only used with -wrong_path)
+#define WRONG_PATH_SET 4096 // recorded paths, direct mapped by branch ip and direction
+#define WRONG_PATH_LINES 8 // code lines fetched down a wrong path at most
+#define WRONG_PATH_PENDING 128 // branches whose path is still being recorded
+
+#if (WRONG_PATH_SET & (WRONG_PATH_SET - 1))
+#error "WRONG_PATH_SET must be a power of two"
+#endif
+
+// the code lines the correct path went through after a branch went one way, and the first load
+// of each line
+class WRONG_PATH_ENTRY {
+  public:
+    uint64_t key, // ip and direction of the branch, 0 while invalid
+             lines[WRONG_PATH_LINES],
+             loads[WRONG_PATH_LINES], // 0 if the line had no load
+             load_ips[WRONG_PATH_LINES];
+    uint32_t num_lines;
+
+    WRONG_PATH_ENTRY() {
+        key = 0;
+        for (uint32_t i=0; i<WRONG_PATH_LINES; i++) {
+            lines[i] = 0;
+            loads[i] = 0;
+            load_ips[i] = 0;
+        }
+        num_lines = 0;
+    };
+};
+
+// synthesizes the addresses fetched down the wrong path of a mispredicted branch: the lines the
+// correct path went through the last time the branch went the way it was predicted, or
+// sequential lines from the predicted target if it never did
+class WRONG_PATH {
+  public:
+    WRONG_PATH_ENTRY paths[WRONG_PATH_SET];
+
+    // the last WRONG_PATH_LINES code lines of the correct path, and the branches still waiting for
+    // the lines after them
+    uint64_t recent_lines[WRONG_PATH_LINES],
+             recent_loads[WRONG_PATH_LINES],
+             recent_load_ips[WRONG_PATH_LINES],
+             num_recent; // lines seen so far, the last one is recent_lines[(num_recent-1) % WRONG_PATH_LINES]
+    deque<pair<uint64_t, uint64_t> > pending; // key, num_recent at the branch
+
+    // the wrong path being fetched
+    WRONG_PATH_ENTRY current;
+    uint32_t next_line;
+    uint8_t  armed, // the branch predictor went down a wrong path, fetch has not reached it yet
+             active;
+    uint64_t last_page;
+
+    // stats
+    uint64_t paths_fetched,
+             paths_replayed, // from a recorded path, the others are sequential
+             lines_fetched,
+             loads_issued;
+
+    WRONG_PATH();
+
+    // every instruction of the correct path, in order
+    void record(ooo_model_instr *instr);
+
+    // the branch predictor sent fetch down a wrong path after the branch at ip, towards target if
+    // taken (0 if unknown); fetch goes there once it reaches the branch
+    void arm(uint64_t ip, uint8_t taken, uint64_t target);
+    void start();
+    void stop();
+
+    // the next wrong-path line to fetch, 0 if there is none, and the load of that line (0 if none)
+    uint64_t line();
+    uint64_t load(uint64_t &ip);
+    void     advance();
+
+    void reset_stats();
+    void print_stats(uint32_t cpu);
+
+  private:
+    uint64_t armed_key,
+             armed_ip,
+             armed_target;
+
+    uint64_t key(uint64_t ip, uint8_t taken);
+    uint32_t index(uint64_t path_key);
+};
+
+#endif
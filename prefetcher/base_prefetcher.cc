@@ -0,0 +1,250 @@
+#include "prefetcher.h"
+
+void CACHE::prefetcher_initialize(const uint8_t *chain, uint32_t length)
+{
+    for (uint32_t i=0; i<length; i++) {
+        switch (chain[i]) {
+            case PF_NONE:
+                break;
+
+            case PF_NEXT_LINE:
+                prefetchers.push_back(new NEXT_LINE_PREFETCHER(this));
+                break;
+
+            case PF_IP_STRIDE:
+                prefetchers.push_back(new IP_STRIDE_PREFETCHER(this));
+                break;
+
+            case PF_STREAM:
+                prefetchers.push_back(new STREAM_PREFETCHER(this));
+                break;
+
+            default:
+                cerr << "[" << NAME << "] " << __func__ << " unknown prefetcher: " << +chain[i] << endl;
+                assert(0);
+        }
+    }
+
+    if (prefetchers.empty())
+        return;
+
+    pf_filter = new uint64_t[PF_FILTER_SIZE];
+    for (uint32_t i=0; i<PF_FILTER_SIZE; i++)
+        pf_filter[i] = 0;
+
+    cout << NAME << " prefetcher chain:";
+    for (uint32_t i=0; i<prefetchers.size(); i++)
+        cout << " " << prefetchers[i]->NAME;
+    cout << endl;
+}
+
+void CACHE::prefetcher_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type)
+{
+    for (uint32_t i=0; i<prefetchers.size(); i++)
+        prefetchers[i]->operate(addr, ip, cache_hit, type);
+}
+
+void CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr)
+{
+    for (uint32_t i=0; i<prefetchers.size(); i++)
+        prefetchers[i]->cache_fill(addr, set, way, prefetch, evicted_addr);
+}
+
+void CACHE::prefetcher_throttle(int32_t direction)
+{
+    for (uint32_t i=0; i<prefetchers.size(); i++) {
+        uint32_t level = prefetchers[i]->aggressiveness;
+        if ((direction > 0) && (level < (PF_AGGRESSIVENESS_LEVELS - 1)))
+            prefetchers[i]->throttle(level + 1);
+        else if ((direction < 0) && (level > 0))
+            prefetchers[i]->throttle(level - 1);
+    }
+}
+
+uint8_t CACHE::filter_prefetch(uint64_t pf_addr)
+{
+    if (pf_filter == NULL)
+        return 0;
+
+    // direct-mapped on the block address, so a hit means the same block was issued recently
+    uint64_t pf_block = pf_addr >> LOG2_BLOCK_SIZE;
+    uint64_t &entry = pf_filter[pf_block & (PF_FILTER_SIZE - 1)];
+    if (entry == pf_block) {
+        pf_filtered++;
+        return 1;
+    }
+
+    entry = pf_block;
+    return 0;
+}
+
+void CACHE::prefetcher_final_stats()
+{
+    fdp.print_stats(NAME);
+
+    if (prefetchers.empty())
+        return;
+
+    cout << NAME << " PREFETCH CHAIN  FILTERED: " << setw(10) << pf_filtered << endl;
+    pf_base_timeliness.print(NAME + " base prefetcher");
+    for (uint32_t i=0; i<prefetchers.size(); i++)
+        prefetchers[i]->final_stats();
+}
+
+int PREFETCHER::issue(uint64_t ip, uint64_t base_addr, uint64_t pf_addr)
+{
+    int pf_fill_level = cache->fill_level;
+    if ((cache->cache_type != IS_LLC) && (cache->MSHR.occupancy >= (cache->MSHR.SIZE>>1)))
+        pf_fill_level <<= 1; // FILL_L1 -> FILL_L2 -> FILL_LLC
+
+    cache->pf_issuer = &timeliness;
+    int issued = cache->prefetch_line(ip, base_addr, pf_addr, pf_fill_level, 0);
+    cache->pf_issuer = NULL;
+
+    return issued;
+}
+
+void PREFETCHER::final_stats()
+{
+    cout << cache->NAME << " " << NAME << "  DEGREE: " << degree << "  DISTANCE: " << distance;
+    cout << "  AGGRESSIVENESS: " << aggressiveness << "/" << (PF_AGGRESSIVENESS_LEVELS - 1) << endl;
+
+    timeliness.print(cache->NAME + " " + NAME);
+}
+
+void PREFETCHER::throttle(uint32_t level)
+{
+    aggressiveness = level;
+    if (level >= PF_DEFAULT_AGGRESSIVENESS) {
+        degree = base_degree << (level - PF_DEFAULT_AGGRESSIVENESS);
+        distance = base_distance << (level - PF_DEFAULT_AGGRESSIVENESS);
+    }
+    else {
+        degree = base_degree >> (PF_DEFAULT_AGGRESSIVENESS - level);
+        distance = base_distance >> (PF_DEFAULT_AGGRESSIVENESS - level);
+    }
+
+    if (degree == 0)
+        degree = 1;
+    if (distance == 0)
+        distance = 1;
+}
+
+void NEXT_LINE_PREFETCHER::operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type)
+{
+    uint64_t cl_addr = addr >> LOG2_BLOCK_SIZE;
+
+    for (uint32_t i=0; i<degree; i++) {
+        uint64_t pf_addr = (cl_addr + distance + i) << LOG2_BLOCK_SIZE;
+        if ((pf_addr >> LOG2_PAGE_SIZE) != (addr >> LOG2_PAGE_SIZE))
+            break;
+
+        issue(ip, addr, pf_addr);
+    }
+}
+
+void IP_STRIDE_PREFETCHER::operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type)
+{
+    uint64_t cl_addr = addr >> LOG2_BLOCK_SIZE;
+
+    uint32_t index;
+    for (index=0; index<STRIDE_TRACKERS; index++) {
+        if (trackers[index].ip == ip)
+            break;
+    }
+
+    if (index == STRIDE_TRACKERS) {
+        // new IP, take over the LRU tracker
+        for (index=0; index<STRIDE_TRACKERS; index++) {
+            if (trackers[index].lru == (STRIDE_TRACKERS-1))
+                break;
+        }
+
+        trackers[index].ip = ip;
+        trackers[index].last_cl_addr = cl_addr;
+        trackers[index].last_stride = 0;
+    }
+    else {
+        int64_t stride = (int64_t) (cl_addr - trackers[index].last_cl_addr);
+
+        // don't do anything if we somehow saw the same address twice in a row
+        if (stride == 0)
+            return;
+
+        // prefetch once the same stride has been seen twice in a row
+        if (stride == trackers[index].last_stride) {
+            for (uint32_t i=0; i<degree; i++) {
+                uint64_t pf_addr = (cl_addr + stride*(distance + i)) << LOG2_BLOCK_SIZE;
+                if ((pf_addr >> LOG2_PAGE_SIZE) != (addr >> LOG2_PAGE_SIZE))
+                    break;
+
+                issue(ip, addr, pf_addr);
+            }
+        }
+
+        trackers[index].last_cl_addr = cl_addr;
+        trackers[index].last_stride = stride;
+    }
+
+    for (uint32_t i=0; i<STRIDE_TRACKERS; i++) {
+        if (trackers[i].lru < trackers[index].lru)
+            trackers[i].lru++;
+    }
+    trackers[index].lru = 0;
+}
+
+void STREAM_PREFETCHER::operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, uint8_t type)
+{
+    const int32_t blocks_per_page = 1 << (LOG2_PAGE_SIZE - LOG2_BLOCK_SIZE);
+
+    uint64_t page = addr >> LOG2_PAGE_SIZE;
+    int32_t offset = (addr >> LOG2_BLOCK_SIZE) & (blocks_per_page - 1);
+
+    uint32_t index;
+    for (index=0; index<STREAM_TRACKERS; index++) {
+        if (trackers[index].page == page)
+            break;
+    }
+
+    if (index == STREAM_TRACKERS) {
+        // new page, take over the LRU tracker
+        for (index=0; index<STREAM_TRACKERS; index++) {
+            if (trackers[index].lru == (STREAM_TRACKERS-1))
+                break;
+        }
+
+        trackers[index].page = page;
+        trackers[index].last_offset = offset;
+        trackers[index].direction = 0;
+        trackers[index].confidence = 0;
+    }
+    else if (offset != trackers[index].last_offset) {
+        int32_t direction = (offset > trackers[index].last_offset) ? 1 : -1;
+        if (direction == trackers[index].direction) {
+            if (trackers[index].confidence < STREAM_CONFIDENCE)
+                trackers[index].confidence++;
+        }
+        else {
+            trackers[index].direction = direction;
+            trackers[index].confidence = 0;
+        }
+
+        if (trackers[index].confidence == STREAM_CONFIDENCE) {
+            for (uint32_t i=0; i<degree; i++) {
+                int32_t pf_offset = offset + direction*(int32_t)(distance + i);
+                if ((pf_offset < 0) || (pf_offset >= blocks_per_page))
+                    break;
+
+                issue(ip, addr, (page << LOG2_PAGE_SIZE) + ((uint64_t) pf_offset << LOG2_BLOCK_SIZE));
+            }
+        }
+
+        trackers[index].last_offset = offset;
+    }
+
+    for (uint32_t i=0; i<STREAM_TRACKERS; i++) {
+        if (trackers[i].lru < trackers[index].lru)
+            trackers[i].lru++;
+    }
+    trackers[index].lru = 0;
+}
@@ -1,19 +1,305 @@
 #include "cache.h"
+#include "ucp.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define SDM_DIVISOR 32 // one leader set per policy in every 32 sets
+#define BIP_MAX 32
+#define PSEL_WIDTH 10
+#define SHCT_SIZE  16384
+#define SHCT_PRIME 16381
+#define SHCT_MAX 7
+
+void CACHE::allocate_repl_state(uint8_t value)
+{
+    repl_state = new uint8_t[NUM_SET*NUM_WAY];
+    for (uint32_t i=0; i<NUM_SET*NUM_WAY; i++)
+        repl_state[i] = value;
+}
+
+void CACHE::initialize_replacement()
+{
+    allocate_repl_state(maxRRPV);
+    if (repl_policy == REPL_LRU) {
+        for (uint32_t i=0; i<NUM_SET; i++) {
+            for (uint32_t j=0; j<NUM_WAY; j++)
+                repl_state[i*NUM_WAY + j] = j;
+        }
+    }
+
+    if (repl_policy == REPL_PLRU) {
+        if (NUM_WAY > 64) {
+            cerr << "[" << NAME << "] " << __func__ << " tree PLRU supports up to 64 ways" << endl;
+            assert(0);
+        }
+
+        plru_tree = new uint64_t[NUM_SET];
+        for (uint32_t i=0; i<NUM_SET; i++)
+            plru_tree[i] = 0;
+    }
+
+    if (repl_policy == REPL_DRRIP) {
+        uint32_t leader_sets = (NUM_SET >= SDM_DIVISOR) ? (NUM_SET / SDM_DIVISOR) : 1;
+        set_dueling.init(NUM_SET, leader_sets, PSEL_WIDTH, LEADER_STRIDED, 1);
+    }
+
+    if (repl_policy == REPL_SHIP) {
+        // private caches train on every set, so there is no sampler
+        ship_signature = new uint16_t[NUM_SET*NUM_WAY];
+        ship_reused = new uint8_t[NUM_SET*NUM_WAY];
+        for (uint32_t i=0; i<NUM_SET*NUM_WAY; i++) {
+            ship_signature[i] = 0;
+            ship_reused[i] = 1;
+        }
+
+        shct = new uint8_t[SHCT_SIZE];
+        for (uint32_t i=0; i<SHCT_SIZE; i++)
+            shct[i] = 0;
+    }
+
+    rand_state = 0x9E3779B97F4A7C15ull ^ NUM_SET;
+}
 
 uint32_t CACHE::find_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, const BLOCK *current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
 {
-    // baseline LRU replacement policy for other caches 
-    return lru_victim(cpu, instr_id, set, current_set, ip, full_addr, type); 
+    uint32_t way;
+
+    // fill invalid line first
+    for (way=0; way<NUM_WAY; way++) {
+        if (block[set][way].valid == false)
+            return way;
+    }
+
+    switch (repl_policy) {
+        case REPL_LRU: {
+            uint8_t *state = &repl_state[set*NUM_WAY];
+            for (way=0; way<NUM_WAY; way++) {
+                if (state[way] == NUM_WAY-1)
+                    break;
+            }
+            break;
+        }
+        case REPL_PLRU:
+            way = plru_victim(set);
+            break;
+        case REPL_SRRIP:
+        case REPL_DRRIP:
+        case REPL_SHIP:
+            way = rrip_victim(set);
+            break;
+        case REPL_RANDOM:
+            // xorshift64
+            rand_state ^= rand_state << 13;
+            rand_state ^= rand_state >> 7;
+            rand_state ^= rand_state << 17;
+            way = rand_state % NUM_WAY;
+            break;
+        default:
+            way = NUM_WAY;
+    }
+
+    DP ( if (warmup_complete[cpu]) {
+    cout << "[" << NAME << "] " << __func__ << " instr_id: " << instr_id << " replace set: " << set << " way: " << way;
+    cout << hex << " address: " << (full_addr>>LOG2_BLOCK_SIZE) << " victim address: " << block[set][way].address << " data: " << block[set][way].data;
+    cout << dec << " state: " << +repl_state[set*NUM_WAY + way] << endl; });
+
+    if (way >= NUM_WAY) {
+        cerr << "[" << NAME << "] " << __func__ << " no victim! set: " << set << endl;
+        assert(0);
+    }
+
+    return way;
 }
 
 void CACHE::update_replacement_state(uint32_t cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type, uint8_t hit)
 {
     if (type == WRITEBACK) {
-        if (hit) // wrietback hit does not update LRU state
+        if (hit) { // wrietback hit does not update LRU state
+            // but for SHiP the line was still worth keeping until its writeback came back
+            if ((repl_policy == REPL_SHIP) && (ship_reused[set*NUM_WAY + way] == 0)) {
+                if (shct[ship_signature[set*NUM_WAY + way]] > 0)
+                    shct[ship_signature[set*NUM_WAY + way]]--;
+                ship_reused[set*NUM_WAY + way] = 1;
+            }
+            return;
+        }
+    }
+
+    uint8_t *state = &repl_state[set*NUM_WAY];
+
+    switch (repl_policy) {
+        case REPL_LRU: {
+            // already MRU, nothing moves
+            uint8_t position = state[way];
+            if (position == 0)
+                return;
+
+            for (uint32_t i=0; i<NUM_WAY; i++) {
+                if (state[i] < position)
+                    state[i]++;
+            }
+            state[way] = 0;
+            return;
+        }
+        case REPL_PLRU:
+            plru_update(set, way);
+            return;
+        case REPL_SRRIP:
+            state[way] = hit ? 0 : maxRRPV-1;
+            return;
+        case REPL_DRRIP:
+            if (hit || (type == WRITEBACK)) {
+                state[way] = hit ? 0 : maxRRPV-1;
+                return;
+            }
+
+            set_dueling.miss(0, set);
+            if (set_dueling.policy(0, set) == 0) { // BIP
+                state[way] = maxRRPV;
+
+                bip_counter++;
+                if (bip_counter == BIP_MAX)
+                    bip_counter = 0;
+                if (bip_counter == 0)
+                    state[way] = maxRRPV-1;
+            } else // SRRIP
+                state[way] = maxRRPV-1;
+            return;
+        case REPL_SHIP: {
+            uint32_t index = set*NUM_WAY + way;
+
+            if (hit) {
+                // a reused line: its signature is not dead
+                if (shct[ship_signature[index]] > 0)
+                    shct[ship_signature[index]]--;
+                ship_reused[index] = 1;
+                state[way] = 0;
+                return;
+            }
+
+            // the line being replaced left without reuse: its signature looks dead
+            if (block[set][way].valid && (ship_reused[index] == 0) && (shct[ship_signature[index]] < SHCT_MAX))
+                shct[ship_signature[index]]++;
+
+            if (type == WRITEBACK) { // writebacks carry no ip, so they do not train
+                ship_reused[index] = 1;
+                state[way] = maxRRPV-1;
+                return;
+            }
+
+            ship_signature[index] = ip % SHCT_PRIME;
+            ship_reused[index] = 0;
+            state[way] = (shct[ship_signature[index]] == SHCT_MAX) ? maxRRPV : maxRRPV-1;
+            return;
+        }
+        default:
             return;
     }
+}
+
+uint32_t CACHE::plru_victim(uint32_t set)
+{
+    // leaves are the ways padded to a power of two, nodes are numbered 1 (root) to leaves-1
+    uint32_t leaves = 1 << const_lg2(NUM_WAY), node = 1;
+    if (leaves < NUM_WAY)
+        leaves <<= 1;
+
+    while (node < leaves) {
+        uint32_t next = 2*node + ((plru_tree[set] >> node) & 1);
+
+        // a right subtree made only of padding ways is never chosen
+        uint32_t first_way = next;
+        while (first_way < leaves)
+            first_way *= 2;
+        if ((first_way - leaves) >= NUM_WAY)
+            next = 2*node;
+
+        node = next;
+    }
+
+    return node - leaves;
+}
 
-    return lru_update(set, way);
+void CACHE::plru_update(uint32_t set, uint32_t way)
+{
+    uint32_t leaves = 1 << const_lg2(NUM_WAY);
+    if (leaves < NUM_WAY)
+        leaves <<= 1;
+
+    // point every node on the path away from the way just touched
+    for (uint32_t node = way + leaves; node > 1; node /= 2) {
+        uint32_t parent = node / 2;
+        if (node & 1)
+            plru_tree[set] &= ~(1ull << parent);
+        else
+            plru_tree[set] |= (1ull << parent);
+    }
+}
+
+uint32_t CACHE::rrip_victim(uint32_t set)
+{
+    uint8_t *state = &repl_state[set*NUM_WAY];
+    uint32_t way;
+
+    // instead of aging the set one step at a time until some line reaches maxRRPV,
+    // every candidate ages at once by maxRRPV minus the oldest candidate's RRPV
+#ifdef __SSE2__
+    if (((NUM_WAY % 16) == 0) && (victim_mask == ~0ull)) {
+        __m128i oldest = _mm_setzero_si128();
+        for (way=0; way<NUM_WAY; way+=16)
+            oldest = _mm_max_epu8(oldest, _mm_loadu_si128((__m128i *) &state[way]));
+        oldest = _mm_max_epu8(oldest, _mm_srli_si128(oldest, 8));
+        oldest = _mm_max_epu8(oldest, _mm_srli_si128(oldest, 4));
+        oldest = _mm_max_epu8(oldest, _mm_srli_si128(oldest, 2));
+        oldest = _mm_max_epu8(oldest, _mm_srli_si128(oldest, 1));
+
+        uint8_t age = maxRRPV - (_mm_cvtsi128_si32(oldest) & 0xFF);
+        __m128i age_v = _mm_set1_epi8(age),
+                max_v = _mm_set1_epi8(maxRRPV);
+
+        for (way=0; way<NUM_WAY; way+=16) {
+            __m128i s_v = _mm_loadu_si128((__m128i *) &state[way]);
+            if (age) {
+                s_v = _mm_adds_epu8(s_v, age_v);
+                _mm_storeu_si128((__m128i *) &state[way], s_v);
+            }
+
+            int match = _mm_movemask_epi8(_mm_cmpeq_epi8(s_v, max_v));
+            if (match) {
+                // finish aging the rest of the set before returning the first maxRRPV way
+                for (uint32_t rest=way+16; age && (rest<NUM_WAY); rest+=16)
+                    _mm_storeu_si128((__m128i *) &state[rest], _mm_adds_epu8(_mm_loadu_si128((__m128i *) &state[rest]), age_v));
+
+                return way + __builtin_ctz(match);
+            }
+        }
+    }
+#endif
+
+    uint8_t oldest = 0;
+    for (way=0; way<NUM_WAY; way++) {
+        if (((victim_mask >> way) & 1) && (state[way] > oldest))
+            oldest = state[way];
+    }
+
+    uint8_t age = maxRRPV - oldest;
+    if (age) {
+        for (way=0; way<NUM_WAY; way++) {
+            if ((victim_mask >> way) & 1)
+                state[way] += age;
+        }
+    }
+
+    for (way=0; way<NUM_WAY; way++) {
+        if (((victim_mask >> way) & 1) && (state[way] == maxRRPV))
+            return way;
+    }
+
+    cerr << "[" << NAME << "] " << __func__ << " no victim! set: " << set << endl;
+    assert(0);
+    return 0;
 }
 
 uint32_t CACHE::lru_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, const BLOCK *current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
@@ -22,7 +308,7 @@ uint32_t CACHE::lru_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, const
 
     // fill invalid line first
     for (way=0; way<NUM_WAY; way++) {
-        if (block[set][way].valid == false) {
+        if ((block[set][way].valid == false) && ((victim_mask >> way) & 1)) {
 
             DP ( if (warmup_complete[cpu]) {
             cout << "[" << NAME << "] " << __func__ << " instr_id: " << instr_id << " invalid set: " << set << " way: " << way;
@@ -33,10 +319,16 @@ uint32_t CACHE::lru_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, const
         }
     }
 
-    // LRU victim
+    // LRU victim (the least recently used of the ways in victim_mask, which is NUM_WAY-1 when nothing is masked)
     if (way == NUM_WAY) {
+        uint32_t max_lru = 0;
         for (way=0; way<NUM_WAY; way++) {
-            if (block[set][way].lru == NUM_WAY-1) {
+            if (((victim_mask >> way) & 1) && (block[set][way].lru >= max_lru))
+                max_lru = block[set][way].lru;
+        }
+
+        for (way=0; way<NUM_WAY; way++) {
+            if (((victim_mask >> way) & 1) && (block[set][way].lru == max_lru)) {
 
                 DP ( if (warmup_complete[cpu]) {
                 cout << "[" << NAME << "] " << __func__ << " instr_id: " << instr_id << " replace set: " << set << " way: " << way;
@@ -56,6 +348,39 @@ uint32_t CACHE::lru_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, const
     return way;
 }
 
+uint32_t CACHE::llc_partition_victim(uint32_t cpu, uint64_t instr_id, uint32_t set, uint64_t ip, uint64_t full_addr, uint32_t type)
+{
+    // the policy only sees the ways the partitioning lets this cpu replace
+    victim_mask = partition->victim_mask(cpu, block[set]);
+    uint32_t way = llc_find_victim(cpu, instr_id, set, block[set], ip, full_addr, type);
+
+    // a policy that ignores victim_mask falls back to the oldest allowed way (bypass is left alone):
+    // the highest RRPV or LRU position in repl_state when the policy keeps one, BLOCK::lru otherwise
+    if ((way < NUM_WAY) && (((victim_mask >> way) & 1) == 0)) {
+        partition->victim_override++;
+
+        if (repl_state) {
+            uint8_t *state = &repl_state[set*NUM_WAY];
+            way = NUM_WAY;
+            for (uint32_t i=0; i<NUM_WAY; i++) {
+                if (((victim_mask >> i) & 1) && ((way == NUM_WAY) || (block[set][i].valid == 0) || (block[set][way].valid && (state[i] > state[way]))))
+                    way = i;
+            }
+
+            if (way == NUM_WAY) {
+                cerr << "[" << NAME << "] " << __func__ << " no victim! set: " << set << endl;
+                assert(0);
+            }
+        }
+        else
+            way = lru_victim(cpu, instr_id, set, block[set], ip, full_addr, type);
+    }
+
+    victim_mask = ~0ull;
+
+    return way;
+}
+
 void CACHE::lru_update(uint32_t set, uint32_t way)
 {
     // update lru replacement state
@@ -0,0 +1,167 @@
+#include "bingo.h"
+
+BINGO::BINGO()
+{
+    for (uint32_t i=0; i<BINGO_AT_SIZE; i++)
+        at[i].lru = i;
+
+    for (uint32_t i=0; i<BINGO_PHT_SET; i++)
+        for (uint32_t j=0; j<BINGO_PHT_WAY; j++)
+            pht[i][j].lru = j;
+
+    triggers = 0;
+    long_hits = 0;
+    short_hits = 0;
+    generations = 0;
+}
+
+uint64_t BINGO::access(uint64_t addr, uint64_t ip)
+{
+    uint64_t region = addr >> BINGO_LOG2_REGION;
+    uint32_t offset = (addr >> LOG2_BLOCK_SIZE) & (BINGO_REGION_BLOCKS - 1);
+
+    uint32_t index;
+    for (index=0; index<BINGO_AT_SIZE; index++) {
+        if (at[index].valid && (at[index].region == region))
+            break;
+    }
+
+    uint64_t prediction = 0;
+    if (index == BINGO_AT_SIZE) {
+        // trigger access: predict the footprint, and start accumulating the new one
+        triggers++;
+        prediction = predict(ip, addr >> LOG2_BLOCK_SIZE) & ~(1ull << offset);
+
+        // a region whose generation evict() already ended, or else the LRU region
+        for (index=0; index<BINGO_AT_SIZE; index++) {
+            if (!at[index].valid)
+                break;
+        }
+        if (index == BINGO_AT_SIZE) {
+            for (index=0; index<BINGO_AT_SIZE; index++) {
+                if (at[index].lru == (BINGO_AT_SIZE-1))
+                    break;
+            }
+        }
+        if (at[index].valid)
+            end_generation(at[index]);
+
+        at[index].valid = 1;
+        at[index].region = region;
+        at[index].ip = ip;
+        at[index].offset = offset;
+        at[index].footprint = 0;
+    }
+
+    at[index].footprint |= (1ull << offset);
+
+    for (uint32_t i=0; i<BINGO_AT_SIZE; i++) {
+        if (at[i].lru < at[index].lru)
+            at[i].lru++;
+    }
+    at[index].lru = 0;
+
+    return prediction;
+}
+
+void BINGO::evict(uint64_t addr)
+{
+    uint64_t region = addr >> BINGO_LOG2_REGION;
+
+    for (uint32_t i=0; i<BINGO_AT_SIZE; i++) {
+        if (at[i].valid && (at[i].region == region)) {
+            end_generation(at[i]);
+            break;
+        }
+    }
+}
+
+void BINGO::end_generation(BINGO_REGION &entry)
+{
+    entry.valid = 0;
+    generations++;
+
+    // regions that only saw their trigger access are kept as well, so they outvote the rare
+    // footprints of the same PC+offset that happened to catch another block
+
+    uint64_t cl_addr = (entry.region << (BINGO_LOG2_REGION - LOG2_BLOCK_SIZE)) + entry.offset;
+    uint32_t long_tag = long_hash(entry.ip, cl_addr),
+             hash = short_hash(entry.ip, entry.offset);
+    BINGO_PATTERN *set = pht[hash % BINGO_PHT_SET];
+
+    // update the footprint of the same PC+address, or fill an invalid way, or replace the LRU pattern
+    uint32_t way;
+    for (way=0; way<BINGO_PHT_WAY; way++) {
+        if (set[way].valid && (set[way].long_tag == long_tag))
+            break;
+    }
+    if (way == BINGO_PHT_WAY) {
+        for (way=0; way<BINGO_PHT_WAY; way++) {
+            if (!set[way].valid)
+                break;
+        }
+    }
+    if (way == BINGO_PHT_WAY) {
+        for (way=0; way<BINGO_PHT_WAY; way++) {
+            if (set[way].lru == (BINGO_PHT_WAY-1))
+                break;
+        }
+    }
+
+    set[way].valid = 1;
+    set[way].long_tag = long_tag;
+    set[way].short_tag = hash >> 16;
+    set[way].footprint = entry.footprint;
+
+    for (uint32_t i=0; i<BINGO_PHT_WAY; i++) {
+        if (set[i].lru < set[way].lru)
+            set[i].lru++;
+    }
+    set[way].lru = 0;
+}
+
+uint64_t BINGO::predict(uint64_t ip, uint64_t cl_addr)
+{
+    uint32_t offset = cl_addr & (BINGO_REGION_BLOCKS - 1);
+    uint32_t long_tag = long_hash(ip, cl_addr),
+             hash = short_hash(ip, offset);
+    BINGO_PATTERN *set = pht[hash % BINGO_PHT_SET];
+
+    // the same PC+address is the most accurate
+    for (uint32_t way=0; way<BINGO_PHT_WAY; way++) {
+        if (set[way].valid && (set[way].long_tag == long_tag)) {
+            long_hits++;
+            return set[way].footprint;
+        }
+    }
+
+    // otherwise vote among all the footprints of the same PC+offset
+    uint32_t matches = 0,
+             votes[BINGO_REGION_BLOCKS] = {0};
+    for (uint32_t way=0; way<BINGO_PHT_WAY; way++) {
+        if (!set[way].valid || (set[way].short_tag != (hash >> 16)))
+            continue;
+
+        matches++;
+        for (uint32_t i=0; i<BINGO_REGION_BLOCKS; i++)
+            votes[i] += (set[way].footprint >> i) & 1;
+    }
+
+    if (matches == 0)
+        return 0;
+    short_hits++;
+
+    uint64_t footprint = 0;
+    for (uint32_t i=0; i<BINGO_REGION_BLOCKS; i++) {
+        if ((100 * votes[i]) >= (BINGO_VOTE * matches))
+            footprint |= (1ull << i);
+    }
+
+    return footprint;
+}
+
+void BINGO::print_stats(string name)
+{
+    cout << name << " BINGO  TRIGGERS: " << setw(10) << triggers << "  LONG HITS: " << setw(10) << long_hits;
+    cout << "  SHORT HITS: " << setw(10) << short_hits << "  FOOTPRINTS: " << setw(10) << generations << endl;
+}
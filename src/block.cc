@@ -17,7 +17,7 @@ int PACKET_QUEUE::check_queue(PACKET *packet)
                 }
             }
             else {
-                if (entry[i].address == packet->address) {
+                if ((entry[i].address == packet->address) && (!match_cpu || (entry[i].cpu == packet->cpu))) {
                     DP (if (warmup_complete[packet->cpu]) {
                     cout << "[" << NAME << "] " << __func__ << " cpu: " << packet->cpu << " instr_id: " << packet->instr_id << " same address: " << hex << packet->address;
                     cout << " full_addr: " << packet->full_addr << dec << " by instr_id: " << entry[i].instr_id << " index: " << i;
@@ -39,7 +39,7 @@ int PACKET_QUEUE::check_queue(PACKET *packet)
                 }
             }
             else {
-                if (entry[i].address == packet->address) {
+                if ((entry[i].address == packet->address) && (!match_cpu || (entry[i].cpu == packet->cpu))) {
                     DP (if (warmup_complete[packet->cpu]) {
                     cout << "[" << NAME << "] " << __func__ << " cpu: " << packet->cpu << " instr_id: " << packet->instr_id << " same address: " << hex << packet->address;
                     cout << " full_addr: " << packet->full_addr << dec << " by instr_id: " << entry[i].instr_id << " index: " << i;
@@ -59,7 +59,7 @@ int PACKET_QUEUE::check_queue(PACKET *packet)
                 }
             }
             else {
-                if (entry[i].address == packet->address) {
+                if ((entry[i].address == packet->address) && (!match_cpu || (entry[i].cpu == packet->cpu))) {
                     DP (if (warmup_complete[packet->cpu]) {
                     cout << "[" << NAME << "] " << __func__ << " cpu: " << packet->cpu << " instr_id: " << packet->instr_id << " same address: " << hex << packet->address;
                     cout << " full_addr: " << packet->full_addr << dec << " by instr_id: " << entry[i].instr_id << " index: " << i;
@@ -0,0 +1,222 @@
+#include "btb.h"
+
+// history bits of every tagged table, the longest used ones are the whole path history
+const uint32_t TARGET_PREDICTOR::history_bits[ITTAGE_TABLES] = { 8, 16, 32, 64 };
+
+TARGET_PREDICTOR::TARGET_PREDICTOR()
+{
+    for (uint32_t i=0; i<BTB_SET; i++)
+        for (uint32_t j=0; j<BTB_WAY; j++)
+            btb[i][j].lru = j;
+
+    for (uint32_t i=0; i<RAS_SIZE; i++)
+        ras[i] = 0;
+    ras_top = 0;
+    ras_count = 0;
+
+    // most calls are 5 bytes long on x86, the rest is learned from the returns
+    for (uint32_t i=0; i<RAS_CALL_SIZE_TRACKERS; i++)
+        call_size[i] = 5;
+
+    path_history = 0;
+
+    last_set = 0;
+    last_way = 0;
+    last_hit = 0;
+    last_target = 0;
+    last_call_ip = 0;
+    last_provider = -1;
+    last_alt = -1;
+    last_alt_target = 0;
+
+    reset_stats();
+}
+
+uint64_t TARGET_PREDICTOR::predict(uint64_t ip, uint8_t branch_type, uint8_t &hit)
+{
+    lookups++;
+
+    last_set = (ip ^ (ip >> 12)) & (BTB_SET - 1);
+    for (last_way=0; last_way<BTB_WAY; last_way++) {
+        if (btb[last_set][last_way].ip == ip)
+            break;
+    }
+    last_hit = (last_way < BTB_WAY);
+    hit = last_hit;
+
+    uint64_t target = last_hit ? btb[last_set][last_way].target : 0;
+
+    // decode knows calls and returns even when the BTB does not, so the RAS always follows them
+    last_call_ip = 0;
+    if (branch_type == BRANCH_RETURN) {
+        if (ras_count) {
+            ras_top = (ras_top + RAS_SIZE - 1) % RAS_SIZE;
+            ras_count--;
+            last_call_ip = ras[ras_top];
+            target = last_call_ip + call_size[last_call_ip & (RAS_CALL_SIZE_TRACKERS - 1)];
+        }
+    }
+    else if ((branch_type == BRANCH_INDIRECT) || (branch_type == BRANCH_INDIRECT_CALL))
+        target = ittage_predict(ip, target);
+
+    if ((branch_type == BRANCH_DIRECT_CALL) || (branch_type == BRANCH_INDIRECT_CALL)) {
+        ras[ras_top] = ip;
+        ras_top = (ras_top + 1) % RAS_SIZE;
+        if (ras_count < RAS_SIZE)
+            ras_count++;
+    }
+
+    last_target = target;
+    return target;
+}
+
+void TARGET_PREDICTOR::update(uint64_t ip, uint8_t branch_type, uint8_t taken, uint64_t target)
+{
+    if (branch_type == BRANCH_RETURN) {
+        returns++;
+        if (last_target != target)
+            return_mispredicts++;
+
+        // learn how long the call was
+        if (last_call_ip && (target > last_call_ip) && ((target - last_call_ip) <= 16))
+            call_size[last_call_ip & (RAS_CALL_SIZE_TRACKERS - 1)] = target - last_call_ip;
+    }
+    else if ((branch_type == BRANCH_INDIRECT) || (branch_type == BRANCH_INDIRECT_CALL)) {
+        indirects++;
+        if (last_target != target)
+            indirect_mispredicts++;
+
+        ittage_update(ip, target);
+    }
+
+    // only taken branches go into the BTB
+    if (!taken)
+        return;
+
+    if (!last_hit) {
+        misses++;
+
+        for (last_way=0; last_way<BTB_WAY; last_way++) {
+            if (btb[last_set][last_way].lru == (BTB_WAY-1))
+                break;
+        }
+        btb[last_set][last_way].ip = ip;
+    }
+    btb[last_set][last_way].target = target;
+
+    for (uint32_t i=0; i<BTB_WAY; i++) {
+        if (btb[last_set][i].lru < btb[last_set][last_way].lru)
+            btb[last_set][i].lru++;
+    }
+    btb[last_set][last_way].lru = 0;
+
+    // two bits that depend on all the bits of the target, which are often aligned
+    path_history = (path_history << 2) | (((target ^ (ip << 1)) * 0x9E3779B97F4A7C15ull) >> 62);
+}
+
+uint64_t TARGET_PREDICTOR::ittage_predict(uint64_t ip, uint64_t base_target)
+{
+    // the longest history that matches provides the target, unless it is not confident yet
+    last_provider = -1;
+    last_alt = -1;
+    for (int i=ITTAGE_TABLES-1; i>=0; i--) {
+        if (ittage[i][ittage_index(ip, i)].tag != ittage_tag(ip, i))
+            continue;
+
+        if (last_provider < 0)
+            last_provider = i;
+        else {
+            last_alt = i;
+            break;
+        }
+    }
+
+    last_alt_target = (last_alt < 0) ? base_target : ittage[last_alt][ittage_index(ip, last_alt)].target;
+    if (last_provider < 0)
+        return last_alt_target;
+
+    ITTAGE_ENTRY &provider = ittage[last_provider][ittage_index(ip, last_provider)];
+    if ((provider.conf > 0) || (last_alt_target == 0))
+        return provider.target;
+
+    return last_alt_target;
+}
+
+void TARGET_PREDICTOR::ittage_update(uint64_t ip, uint64_t target)
+{
+    if (last_provider >= 0) {
+        ITTAGE_ENTRY &provider = ittage[last_provider][ittage_index(ip, last_provider)];
+        if (provider.target == target) {
+            if (provider.conf < ITTAGE_CONF_MAX)
+                provider.conf++;
+            if ((last_alt_target != target) && (provider.useful < ITTAGE_USEFUL_MAX))
+                provider.useful++;
+        }
+        else {
+            if (provider.conf > 0)
+                provider.conf--;
+            else
+                provider.target = target;
+            if ((last_alt_target == target) && (provider.useful > 0))
+                provider.useful--;
+        }
+    }
+
+    if ((last_target == target) || (last_provider == (ITTAGE_TABLES-1)))
+        return;
+
+    // mispredicted: allocate an entry with a longer history, or age the ones in the way
+    for (int i=last_provider+1; i<ITTAGE_TABLES; i++) {
+        ITTAGE_ENTRY &entry = ittage[i][ittage_index(ip, i)];
+        if (entry.useful == 0) {
+            entry.tag = ittage_tag(ip, i);
+            entry.target = target;
+            entry.conf = 0;
+            return;
+        }
+    }
+
+    for (int i=last_provider+1; i<ITTAGE_TABLES; i++)
+        ittage[i][ittage_index(ip, i)].useful--;
+}
+
+uint64_t TARGET_PREDICTOR::fold_history(uint32_t length, uint32_t bits)
+{
+    uint64_t history = (length < 64) ? (path_history & ((1ull << length) - 1)) : path_history,
+             folded = 0;
+    for (uint32_t i=0; i<length; i+=bits)
+        folded ^= history >> i;
+
+    return folded & ((1ull << bits) - 1);
+}
+
+uint32_t TARGET_PREDICTOR::ittage_index(uint64_t ip, int table)
+{
+    return (ip ^ (ip >> ITTAGE_LOG2_SIZE) ^ (table << 3) ^ fold_history(history_bits[table], ITTAGE_LOG2_SIZE)) & ((1 << ITTAGE_LOG2_SIZE) - 1);
+}
+
+uint16_t TARGET_PREDICTOR::ittage_tag(uint64_t ip, int table)
+{
+    // a tag of 0 never matches, so the empty entries stay empty
+    uint16_t tag = (ip ^ (ip >> ITTAGE_TAG_BITS) ^ fold_history(history_bits[table], ITTAGE_TAG_BITS) ^ (fold_history(history_bits[table], ITTAGE_TAG_BITS-1) << 1)) & ((1 << ITTAGE_TAG_BITS) - 1);
+    return tag ? tag : 1;
+}
+
+void TARGET_PREDICTOR::reset_stats()
+{
+    lookups = 0;
+    misses = 0;
+    returns = 0;
+    return_mispredicts = 0;
+    indirects = 0;
+    indirect_mispredicts = 0;
+    decode_redirects = 0;
+}
+
+void TARGET_PREDICTOR::print_stats(uint32_t cpu)
+{
+    cout << "CPU " << cpu << " BTB     LOOKUPS: " << setw(10) << lookups << "  MISSES: " << setw(10) << misses;
+    cout << "  DECODE REDIRECTS: " << setw(10) << decode_redirects << endl;
+    cout << "CPU " << cpu << " RAS     RETURNS: " << setw(10) << returns << "  MISPREDICTED: " << setw(10) << return_mispredicts << endl;
+    cout << "CPU " << cpu << " ITTAGE  INDIRECT: " << setw(10) << indirects << "  MISPREDICTED: " << setw(10) << indirect_mispredicts << endl;
+}
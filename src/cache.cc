@@ -1,8 +1,14 @@
 #include "cache.h"
 #include "set.h"
+#include "directory.h"
+#include "ucp.h"
+#include "pc_profile.h"
+
+#include <set>
 
 uint64_t l2pf_access = 0;
 
+template <uint8_t LEVEL>
 void CACHE::handle_fill()
 {
     // handle fill
@@ -19,19 +25,48 @@ void CACHE::handle_fill()
 
         uint32_t mshr_index = MSHR.next_fill_index;
 
+        // exclusive LLC: demand data goes straight up, only upper level victims are allocated here
+        if ((LEVEL == IS_LLC) && (inclusion_policy == EXCLUSIVE) && (MSHR.entry[mshr_index].fill_level < fill_level)) {
+
+            // COLLECT STATS
+            sim_miss[fill_cpu][MSHR.entry[mshr_index].type]++;
+            sim_access[fill_cpu][MSHR.entry[mshr_index].type]++;
+
+            if (MSHR.entry[mshr_index].instruction)
+                upper_level_icache[fill_cpu]->return_data(&MSHR.entry[mshr_index]);
+            if (MSHR.entry[mshr_index].is_data)
+                upper_level_dcache[fill_cpu]->return_data(&MSHR.entry[mshr_index]);
+
+            if (warmup_complete[fill_cpu] && (MSHR.entry[mshr_index].cycle_enqueued != 0)) {
+                total_miss_latency += (current_core_cycle[fill_cpu] - MSHR.entry[mshr_index].cycle_enqueued);
+                if (!simulation_complete[fill_cpu])
+                    mshr_residency.add(current_core_cycle[fill_cpu] - MSHR.entry[mshr_index].cycle_enqueued);
+            }
+
+            MSHR.remove_queue(&MSHR.entry[mshr_index]);
+            MSHR.num_returned--;
+
+            update_fill_cycle();
+
+            return;
+        }
+
         // find victim
         uint32_t set = get_set(MSHR.entry[mshr_index].address), way;
-        if (cache_type == IS_LLC) {
-            way = llc_find_victim(fill_cpu, MSHR.entry[mshr_index].instr_id, set, block[set], MSHR.entry[mshr_index].ip, MSHR.entry[mshr_index].full_addr, MSHR.entry[mshr_index].type);
+        if (LEVEL == IS_LLC) {
+            if (partition)
+                way = llc_partition_victim(fill_cpu, MSHR.entry[mshr_index].instr_id, set, MSHR.entry[mshr_index].ip, MSHR.entry[mshr_index].full_addr, MSHR.entry[mshr_index].type);
+            else
+                way = llc_find_victim(fill_cpu, MSHR.entry[mshr_index].instr_id, set, block[set], MSHR.entry[mshr_index].ip, MSHR.entry[mshr_index].full_addr, MSHR.entry[mshr_index].type);
         }
         else
             way = find_victim(fill_cpu, MSHR.entry[mshr_index].instr_id, set, block[set], MSHR.entry[mshr_index].ip, MSHR.entry[mshr_index].full_addr, MSHR.entry[mshr_index].type);
 
 #ifdef LLC_BYPASS
-        if ((cache_type == IS_LLC) && (way == LLC_WAY)) { // this is a bypass that does not fill the LLC
+        if ((LEVEL == IS_LLC) && (way == LLC_WAY)) { // this is a bypass that does not fill the LLC
 
             // update replacement policy
-            if (cache_type == IS_LLC) {
+            if (LEVEL == IS_LLC) {
                 llc_update_replacement_state(fill_cpu, set, way, MSHR.entry[mshr_index].full_addr, MSHR.entry[mshr_index].ip, 0, MSHR.entry[mshr_index].type, 0);
 
             }
@@ -69,6 +104,8 @@ void CACHE::handle_fill()
 	      {
 		uint64_t current_miss_latency = (current_core_cycle[fill_cpu] - MSHR.entry[mshr_index].cycle_enqueued);
 		total_miss_latency += current_miss_latency;
+		if (!simulation_complete[fill_cpu])
+		    mshr_residency.add(current_miss_latency);
 	      }
 
             MSHR.remove_queue(&MSHR.entry[mshr_index]);
@@ -80,10 +117,14 @@ void CACHE::handle_fill()
         }
 #endif
 
+        // inclusive: the victim must leave every upper level too, keeping any dirty data
+        if ((inclusion_policy == INCLUSIVE) && block[set][way].valid && back_invalidate(block[set][way].address))
+            block[set][way].dirty = 1;
+
         uint8_t  do_fill = 1;
 
-        // is this dirty?
-        if (block[set][way].dirty) {
+        // is this dirty? (or a clean victim that the exclusive lower level wants)
+        if (block[set][way].dirty || (writeback_clean_victims && block[set][way].valid)) {
 
             // check if the lower level WQ has enough room to keep this writeback request
             if (lower_level) {
@@ -107,6 +148,7 @@ void CACHE::handle_fill()
                     writeback_packet.address = block[set][way].address;
                     writeback_packet.full_addr = block[set][way].full_addr;
                     writeback_packet.data = block[set][way].data;
+                    writeback_packet.dirty = block[set][way].dirty;
                     writeback_packet.instr_id = MSHR.entry[mshr_index].instr_id;
                     writeback_packet.ip = 0; // writeback does not have ip
                     writeback_packet.type = WRITEBACK;
@@ -118,7 +160,7 @@ void CACHE::handle_fill()
 #ifdef SANITY_CHECK
             else {
                 // sanity check
-                if (cache_type != IS_STLB)
+                if (LEVEL != IS_STLB)
                     assert(0);
             }
 #endif
@@ -126,24 +168,30 @@ void CACHE::handle_fill()
 
         if (do_fill){
             // update prefetcher
-	  if (cache_type == IS_L1I)
+	  if (LEVEL == IS_L1I)
 	    l1i_prefetcher_cache_fill(fill_cpu, ((MSHR.entry[mshr_index].ip)>>LOG2_BLOCK_SIZE)<<LOG2_BLOCK_SIZE, set, way, (MSHR.entry[mshr_index].type == PREFETCH) ? 1 : 0, ((block[set][way].ip)>>LOG2_BLOCK_SIZE)<<LOG2_BLOCK_SIZE);
-	    if (cache_type == IS_L1D)
+	    if (LEVEL == IS_L1D)
 	      l1d_prefetcher_cache_fill(MSHR.entry[mshr_index].full_addr, set, way, (MSHR.entry[mshr_index].type == PREFETCH) ? 1 : 0, block[set][way].address<<LOG2_BLOCK_SIZE,
-					MSHR.entry[mshr_index].pf_metadata);
-	    if  (cache_type == IS_L2C)
+					MSHR.entry[mshr_index].pf_metadata, MSHR.entry[mshr_index].cycle_enqueued ? (current_core_cycle[fill_cpu] - MSHR.entry[mshr_index].cycle_enqueued) : 0);
+	    if  (LEVEL == IS_L2C)
 	      MSHR.entry[mshr_index].pf_metadata = l2c_prefetcher_cache_fill(MSHR.entry[mshr_index].address<<LOG2_BLOCK_SIZE, set, way, (MSHR.entry[mshr_index].type == PREFETCH) ? 1 : 0,
 									     block[set][way].address<<LOG2_BLOCK_SIZE, MSHR.entry[mshr_index].pf_metadata);
-            if (cache_type == IS_LLC)
+            if (LEVEL == IS_LLC)
 	      {
 		cpu = fill_cpu;
 		MSHR.entry[mshr_index].pf_metadata = llc_prefetcher_cache_fill(MSHR.entry[mshr_index].address<<LOG2_BLOCK_SIZE, set, way, (MSHR.entry[mshr_index].type == PREFETCH) ? 1 : 0,
 									       block[set][way].address<<LOG2_BLOCK_SIZE, MSHR.entry[mshr_index].pf_metadata);
 		cpu = 0;
 	      }
+            if (prefetchers.size()) {
+                cpu = fill_cpu;
+                prefetcher_cache_fill(MSHR.entry[mshr_index].address<<LOG2_BLOCK_SIZE, set, way, (MSHR.entry[mshr_index].type == PREFETCH) ? 1 : 0, block[set][way].address<<LOG2_BLOCK_SIZE);
+                if (LEVEL == IS_LLC)
+                    cpu = 0;
+            }
               
             // update replacement policy
-            if (cache_type == IS_LLC) {
+            if (LEVEL == IS_LLC) {
                 llc_update_replacement_state(fill_cpu, set, way, MSHR.entry[mshr_index].full_addr, MSHR.entry[mshr_index].ip, block[set][way].full_addr, MSHR.entry[mshr_index].type, 0);
             }
             else
@@ -155,8 +203,14 @@ void CACHE::handle_fill()
 
             fill_cache(set, way, &MSHR.entry[mshr_index]);
 
+            // a line promoted out of an exclusive LLC, or taken from another core's modified copy, keeps its dirty state
+            if ((LEVEL == IS_L2C) && MSHR.entry[mshr_index].dirty) {
+                block[set][way].dirty = 1;
+                MSHR.entry[mshr_index].dirty = 0;
+            }
+
             // RFO marks cache line dirty
-            if (cache_type == IS_L1D) {
+            if (LEVEL == IS_L1D) {
                 if (MSHR.entry[mshr_index].type == RFO)
                     block[set][way].dirty = 1;
             }
@@ -185,22 +239,22 @@ void CACHE::handle_fill()
             }
 
             // update processed packets
-            if (cache_type == IS_ITLB) { 
+            if (LEVEL == IS_ITLB) { 
                 MSHR.entry[mshr_index].instruction_pa = block[set][way].data;
                 if (PROCESSED.occupancy < PROCESSED.SIZE)
                     PROCESSED.add_queue(&MSHR.entry[mshr_index]);
             }
-            else if (cache_type == IS_DTLB) {
+            else if (LEVEL == IS_DTLB) {
                 MSHR.entry[mshr_index].data_pa = block[set][way].data;
                 if (PROCESSED.occupancy < PROCESSED.SIZE)
                     PROCESSED.add_queue(&MSHR.entry[mshr_index]);
             }
-            else if (cache_type == IS_L1I) {
+            else if (LEVEL == IS_L1I) {
                 if (PROCESSED.occupancy < PROCESSED.SIZE)
                     PROCESSED.add_queue(&MSHR.entry[mshr_index]);
             }
-            //else if (cache_type == IS_L1D) {
-            else if ((cache_type == IS_L1D) && (MSHR.entry[mshr_index].type != PREFETCH)) {
+            //else if (LEVEL == IS_L1D) {
+            else if ((LEVEL == IS_L1D) && (MSHR.entry[mshr_index].type != PREFETCH)) {
                 if (PROCESSED.occupancy < PROCESSED.SIZE)
                     PROCESSED.add_queue(&MSHR.entry[mshr_index]);
             }
@@ -208,13 +262,24 @@ void CACHE::handle_fill()
 	    if(warmup_complete[fill_cpu] && (MSHR.entry[mshr_index].cycle_enqueued != 0))
 	      {
 		uint64_t current_miss_latency = (current_core_cycle[fill_cpu] - MSHR.entry[mshr_index].cycle_enqueued);
+
+		// coherence misses are charged to the level that asked for the block
+		if (MSHR.entry[mshr_index].coherence_miss && (MSHR.entry[mshr_index].fill_level == fill_level)) {
+		    coherence_misses++;
+		    coherence_miss_latency += current_miss_latency;
+		}
 		/*
-		if(cache_type == IS_L1D)
+		if(LEVEL == IS_L1D)
 		  {
 		    cout << current_core_cycle[fill_cpu] << " - " << MSHR.entry[mshr_index].cycle_enqueued << " = " << current_miss_latency << " MSHR index: " << mshr_index << endl;
 		  }
 		*/
 		total_miss_latency += current_miss_latency;
+		if (!simulation_complete[fill_cpu])
+		    mshr_residency.add(current_miss_latency);
+
+		if (pc_profile && (MSHR.entry[mshr_index].type == LOAD) && (MSHR.entry[mshr_index].instruction == 0))
+		    pc_profile->fill(fill_cpu, LEVEL, MSHR.entry[mshr_index].ip, current_miss_latency);
 	      }
 	  
             MSHR.remove_queue(&MSHR.entry[mshr_index]);
@@ -225,6 +290,7 @@ void CACHE::handle_fill()
     }
 }
 
+template <uint8_t LEVEL>
 void CACHE::handle_writeback()
 {
     // handle write
@@ -239,10 +305,25 @@ void CACHE::handle_writeback()
         // access cache
         uint32_t set = get_set(WQ.entry[index].address);
         int way = check_hit(&WQ.entry[index]);
+
+        // shared address space: a store to a block this core does not own has to upgrade at the directory
+        if ((LEVEL == IS_L1D) && directory && (way >= 0) && !directory->is_owner(writeback_cpu, WQ.entry[index].address)) {
+            // a copy left dirty by a downgrade goes back to the LLC first, or the store waits
+            if (block[set][way].dirty) {
+                if (!directory->write_back(writeback_cpu, WQ.entry[index].address)) {
+                    STALL[WQ.entry[index].type]++;
+                    return;
+                }
+                block[set][way].dirty = 0;
+            }
+            block[set][way].valid = 0;
+            WQ.entry[index].coherence_miss = 1;
+            way = -1;
+        }
         
         if (way >= 0) { // writeback hit (or RFO hit for L1D)
 
-            if (cache_type == IS_LLC) {
+            if (LEVEL == IS_LLC) {
                 llc_update_replacement_state(writeback_cpu, set, way, block[set][way].full_addr, WQ.entry[index].ip, 0, WQ.entry[index].type, 1);
 
             }
@@ -253,14 +334,15 @@ void CACHE::handle_writeback()
             sim_hit[writeback_cpu][WQ.entry[index].type]++;
             sim_access[writeback_cpu][WQ.entry[index].type]++;
 
-            // mark dirty
-            block[set][way].dirty = 1;
+            // mark dirty, clean victims written into an exclusive cache stay clean
+            if (WQ.entry[index].dirty || (inclusion_policy != EXCLUSIVE))
+                block[set][way].dirty = 1;
 
-            if (cache_type == IS_ITLB)
+            if (LEVEL == IS_ITLB)
                 WQ.entry[index].instruction_pa = block[set][way].data;
-            else if (cache_type == IS_DTLB)
+            else if (LEVEL == IS_DTLB)
                 WQ.entry[index].data_pa = block[set][way].data;
-            else if (cache_type == IS_STLB)
+            else if (LEVEL == IS_STLB)
                 WQ.entry[index].data = block[set][way].data;
 
             // check fill level
@@ -300,7 +382,7 @@ void CACHE::handle_writeback()
             cout << " full_addr: " << WQ.entry[index].full_addr << dec;
             cout << " cycle: " << WQ.entry[index].event_cycle << endl; });
 
-            if (cache_type == IS_L1D) { // RFO miss
+            if (LEVEL == IS_L1D) { // RFO miss
 
                 // check mshr
                 uint8_t miss_handled = 1;
@@ -313,7 +395,7 @@ void CACHE::handle_writeback()
 		  }
                 else if ((mshr_index == -1) && (MSHR.occupancy < MSHR_SIZE)) { // this is a new miss
 
-		  if(cache_type == IS_LLC)
+		  if(LEVEL == IS_LLC)
 		    {
 		      // check to make sure the DRAM RQ has room for this LLC RFO miss
 		      if (lower_level->get_occupancy(1, WQ.entry[index].address) == lower_level->get_size(1, WQ.entry[index].address))
@@ -397,23 +479,30 @@ void CACHE::handle_writeback()
             else {
                 // find victim
                 uint32_t set = get_set(WQ.entry[index].address), way;
-                if (cache_type == IS_LLC) {
-                    way = llc_find_victim(writeback_cpu, WQ.entry[index].instr_id, set, block[set], WQ.entry[index].ip, WQ.entry[index].full_addr, WQ.entry[index].type);
+                if (LEVEL == IS_LLC) {
+                    if (partition)
+                        way = llc_partition_victim(writeback_cpu, WQ.entry[index].instr_id, set, WQ.entry[index].ip, WQ.entry[index].full_addr, WQ.entry[index].type);
+                    else
+                        way = llc_find_victim(writeback_cpu, WQ.entry[index].instr_id, set, block[set], WQ.entry[index].ip, WQ.entry[index].full_addr, WQ.entry[index].type);
                 }
                 else
                     way = find_victim(writeback_cpu, WQ.entry[index].instr_id, set, block[set], WQ.entry[index].ip, WQ.entry[index].full_addr, WQ.entry[index].type);
 
 #ifdef LLC_BYPASS
-                if ((cache_type == IS_LLC) && (way == LLC_WAY)) {
+                if ((LEVEL == IS_LLC) && (way == LLC_WAY)) {
                     cerr << "LLC bypassing for writebacks is not allowed!" << endl;
                     assert(0);
                 }
 #endif
 
+                // inclusive: the victim must leave every upper level too, keeping any dirty data
+                if ((inclusion_policy == INCLUSIVE) && block[set][way].valid && back_invalidate(block[set][way].address))
+                    block[set][way].dirty = 1;
+
                 uint8_t  do_fill = 1;
 
-                // is this dirty?
-                if (block[set][way].dirty) {
+                // is this dirty? (or a clean victim that the exclusive lower level wants)
+                if (block[set][way].dirty || (writeback_clean_victims && block[set][way].valid)) {
 
                     // check if the lower level WQ has enough room to keep this writeback request
                     if (lower_level) { 
@@ -437,6 +526,7 @@ void CACHE::handle_writeback()
                             writeback_packet.address = block[set][way].address;
                             writeback_packet.full_addr = block[set][way].full_addr;
                             writeback_packet.data = block[set][way].data;
+                            writeback_packet.dirty = block[set][way].dirty;
                             writeback_packet.instr_id = WQ.entry[index].instr_id;
                             writeback_packet.ip = 0;
                             writeback_packet.type = WRITEBACK;
@@ -448,7 +538,7 @@ void CACHE::handle_writeback()
 #ifdef SANITY_CHECK
                     else {
                         // sanity check
-                        if (cache_type != IS_STLB)
+                        if (LEVEL != IS_STLB)
                             assert(0);
                     }
 #endif
@@ -456,23 +546,29 @@ void CACHE::handle_writeback()
 
                 if (do_fill) {
                     // update prefetcher
-		  if (cache_type == IS_L1I)
+		  if (LEVEL == IS_L1I)
 		    l1i_prefetcher_cache_fill(writeback_cpu, ((WQ.entry[index].ip)>>LOG2_BLOCK_SIZE)<<LOG2_BLOCK_SIZE, set, way, 0, ((block[set][way].ip)>>LOG2_BLOCK_SIZE)<<LOG2_BLOCK_SIZE);
-                    if (cache_type == IS_L1D)
-		      l1d_prefetcher_cache_fill(WQ.entry[index].full_addr, set, way, 0, block[set][way].address<<LOG2_BLOCK_SIZE, WQ.entry[index].pf_metadata);
-                    else if (cache_type == IS_L2C)
+                    if (LEVEL == IS_L1D)
+		      l1d_prefetcher_cache_fill(WQ.entry[index].full_addr, set, way, 0, block[set][way].address<<LOG2_BLOCK_SIZE, WQ.entry[index].pf_metadata, 0);
+                    else if (LEVEL == IS_L2C)
 		      WQ.entry[index].pf_metadata = l2c_prefetcher_cache_fill(WQ.entry[index].address<<LOG2_BLOCK_SIZE, set, way, 0,
 									      block[set][way].address<<LOG2_BLOCK_SIZE, WQ.entry[index].pf_metadata);
-                    if (cache_type == IS_LLC)
+                    if (LEVEL == IS_LLC)
 		      {
 			cpu = writeback_cpu;
 			WQ.entry[index].pf_metadata =llc_prefetcher_cache_fill(WQ.entry[index].address<<LOG2_BLOCK_SIZE, set, way, 0,
 									       block[set][way].address<<LOG2_BLOCK_SIZE, WQ.entry[index].pf_metadata);
 			cpu = 0;
 		      }
+                    if (prefetchers.size()) {
+                        cpu = writeback_cpu;
+                        prefetcher_cache_fill(WQ.entry[index].address<<LOG2_BLOCK_SIZE, set, way, 0, block[set][way].address<<LOG2_BLOCK_SIZE);
+                        if (LEVEL == IS_LLC)
+                            cpu = 0;
+                    }
 
                     // update replacement policy
-                    if (cache_type == IS_LLC) {
+                    if (LEVEL == IS_LLC) {
                         llc_update_replacement_state(writeback_cpu, set, way, WQ.entry[index].full_addr, WQ.entry[index].ip, block[set][way].full_addr, WQ.entry[index].type, 0);
                     }
                     else
@@ -484,8 +580,11 @@ void CACHE::handle_writeback()
 
                     fill_cache(set, way, &WQ.entry[index]);
 
-                    // mark dirty
-                    block[set][way].dirty = 1; 
+                    // mark dirty, clean victims written into an exclusive cache stay clean
+                    if (WQ.entry[index].dirty || (inclusion_policy != EXCLUSIVE))
+                        block[set][way].dirty = 1;
+                    if (inclusion_policy == EXCLUSIVE)
+                        exclusive_victim_fills++;
 
                     // check fill level
                     if (WQ.entry[index].fill_level < fill_level) {
@@ -521,6 +620,7 @@ void CACHE::handle_writeback()
     }
 }
 
+template <uint8_t LEVEL>
 void CACHE::handle_read()
 {
     // handle read
@@ -534,52 +634,82 @@ void CACHE::handle_read()
         if ((RQ.entry[RQ.head].event_cycle <= current_core_cycle[read_cpu]) && (RQ.occupancy > 0)) {
             int index = RQ.head;
 
+            // shared address space: the directory resolves the other cores' copies first
+            if ((LEVEL == IS_LLC) && directory && (RQ.entry[index].fill_level < fill_level)) {
+                uint32_t coherence_delay = directory->handle_request(&RQ.entry[index]);
+                if (coherence_delay) {
+                    RQ.entry[index].event_cycle = current_core_cycle[read_cpu] + coherence_delay;
+                    continue;
+                }
+            }
+
             // access cache
             uint32_t set = get_set(RQ.entry[index].address);
             int way = check_hit(&RQ.entry[index]);
+
+            // shared address space: a store to a block this core does not own has to upgrade at the directory
+            if ((LEVEL == IS_L2C) && directory && (way >= 0) && (RQ.entry[index].type == RFO) && !directory->is_owner(read_cpu, RQ.entry[index].address)) {
+                // a copy left dirty by a downgrade goes back to the LLC first, or the store waits
+                if (block[set][way].dirty) {
+                    if (!directory->write_back(read_cpu, RQ.entry[index].address)) {
+                        STALL[RQ.entry[index].type]++;
+                        return;
+                    }
+                    block[set][way].dirty = 0;
+                }
+                block[set][way].valid = 0;
+                RQ.entry[index].coherence_miss = 1;
+                way = -1;
+            }
             
             if (way >= 0) { // read hit
 
-                if (cache_type == IS_ITLB) {
+                if (LEVEL == IS_ITLB) {
                     RQ.entry[index].instruction_pa = block[set][way].data;
                     if (PROCESSED.occupancy < PROCESSED.SIZE)
                         PROCESSED.add_queue(&RQ.entry[index]);
                 }
-                else if (cache_type == IS_DTLB) {
+                else if (LEVEL == IS_DTLB) {
                     RQ.entry[index].data_pa = block[set][way].data;
                     if (PROCESSED.occupancy < PROCESSED.SIZE)
                         PROCESSED.add_queue(&RQ.entry[index]);
                 }
-                else if (cache_type == IS_STLB) 
+                else if (LEVEL == IS_STLB) 
                     RQ.entry[index].data = block[set][way].data;
-                else if (cache_type == IS_L1I) {
+                else if (LEVEL == IS_L1I) {
                     if (PROCESSED.occupancy < PROCESSED.SIZE)
                         PROCESSED.add_queue(&RQ.entry[index]);
                 }
-                //else if (cache_type == IS_L1D) {
-                else if ((cache_type == IS_L1D) && (RQ.entry[index].type != PREFETCH)) {
+                //else if (LEVEL == IS_L1D) {
+                else if ((LEVEL == IS_L1D) && (RQ.entry[index].type != PREFETCH)) {
                     if (PROCESSED.occupancy < PROCESSED.SIZE)
                         PROCESSED.add_queue(&RQ.entry[index]);
                 }
 
                 // update prefetcher on load instruction
 		if (RQ.entry[index].type == LOAD) {
-		    if(cache_type == IS_L1I)
+		    if(LEVEL == IS_L1I)
 		      l1i_prefetcher_cache_operate(read_cpu, RQ.entry[index].ip, 1, block[set][way].prefetch);
-                    if (cache_type == IS_L1D) 
+                    if (LEVEL == IS_L1D) 
 		      l1d_prefetcher_operate(RQ.entry[index].full_addr, RQ.entry[index].ip, 1, RQ.entry[index].type);
-                    else if (cache_type == IS_L2C)
+                    else if (LEVEL == IS_L2C)
 		      l2c_prefetcher_operate(block[set][way].address<<LOG2_BLOCK_SIZE, RQ.entry[index].ip, 1, RQ.entry[index].type, 0);
-                    else if (cache_type == IS_LLC)
+                    else if (LEVEL == IS_LLC)
 		      {
 			cpu = read_cpu;
 			llc_prefetcher_operate(block[set][way].address<<LOG2_BLOCK_SIZE, RQ.entry[index].ip, 1, RQ.entry[index].type, 0);
 			cpu = 0;
 		      }
+                    if (prefetchers.size()) {
+                        cpu = read_cpu;
+                        prefetcher_operate(RQ.entry[index].address<<LOG2_BLOCK_SIZE, RQ.entry[index].ip, 1, RQ.entry[index].type);
+                        if (LEVEL == IS_LLC)
+                            cpu = 0;
+                    }
                 }
 
                 // update replacement policy
-                if (cache_type == IS_LLC) {
+                if (LEVEL == IS_LLC) {
                     llc_update_replacement_state(read_cpu, set, way, block[set][way].full_addr, RQ.entry[index].ip, 0, RQ.entry[index].type, 1);
 
                 }
@@ -590,6 +720,20 @@ void CACHE::handle_read()
                 sim_hit[read_cpu][RQ.entry[index].type]++;
                 sim_access[read_cpu][RQ.entry[index].type]++;
 
+                if ((LEVEL == IS_LLC) && partition)
+                    partition->observe(read_cpu, RQ.entry[index].address);
+
+                if (pc_profile && (RQ.entry[index].type == LOAD) && (RQ.entry[index].instruction == 0))
+                    pc_profile->access(read_cpu, LEVEL, RQ.entry[index].ip, 1, block[set][way].prefetch);
+
+                if (reuse_profile.enabled())
+                    reuse_profile.access_block(RQ.entry[index].address, warmup_complete[read_cpu] && !simulation_complete[read_cpu]);
+
+                // exclusive LLC: a hit moves the line up to the requester
+                uint8_t promote = (LEVEL == IS_LLC) && (inclusion_policy == EXCLUSIVE) && (RQ.entry[index].fill_level < fill_level);
+                if (promote)
+                    RQ.entry[index].dirty |= block[set][way].dirty;
+
                 // check fill level
                 if (RQ.entry[index].fill_level < fill_level) {
 
@@ -616,10 +760,28 @@ void CACHE::handle_read()
                 // update prefetch stats and reset prefetch bit
                 if (block[set][way].prefetch) {
                     pf_useful++;
+                    if (RQ.entry[index].type != PREFETCH) {
+                        // (cores of a shared cache are not in lockstep)
+                        uint64_t earliness = (current_core_cycle[read_cpu] > block[set][way].fill_cycle) ? (current_core_cycle[read_cpu] - block[set][way].fill_cycle) : 0;
+                        pf_timeliness.timely++;
+                        pf_timeliness.earliness.add(earliness);
+                        if (block[set][way].pf_source) {
+                            block[set][way].pf_source->timely++;
+                            block[set][way].pf_source->earliness.add(earliness);
+                        }
+                    }
+                    if (fdp.enabled() && (RQ.entry[index].type != PREFETCH))
+                        fdp.prefetch_used();
                     block[set][way].prefetch = 0;
                 }
                 block[set][way].used = 1;
 
+                if (promote) {
+                    block[set][way].valid = 0;
+                    block[set][way].dirty = 0;
+                    exclusive_promotions++;
+                }
+
                 HIT[RQ.entry[index].type]++;
                 ACCESS[RQ.entry[index].type]++;
                 
@@ -639,6 +801,10 @@ void CACHE::handle_read()
                 uint8_t miss_handled = 1;
                 int mshr_index = check_mshr(&RQ.entry[index]);
 
+                // shared address space: wait for another core's miss to the same block to finish
+                if ((LEVEL == IS_LLC) && directory && (mshr_index >= 0) && (MSHR.entry[mshr_index].cpu != read_cpu))
+                    mshr_index = -2;
+
 		if(mshr_index == -2)
 		  {
 		    // this is a data/instruction collision in the MSHR, so we have to wait before we can allocate this miss
@@ -646,7 +812,7 @@ void CACHE::handle_read()
 		  }
                 else if ((mshr_index == -1) && (MSHR.occupancy < MSHR_SIZE)) { // this is a new miss
 
-		  if(cache_type == IS_LLC)
+		  if(LEVEL == IS_LLC)
 		    {
 		      // check to make sure the DRAM RQ has room for this LLC read miss
 		      if (lower_level->get_occupancy(1, RQ.entry[index].address) == lower_level->get_size(1, RQ.entry[index].address))
@@ -671,7 +837,7 @@ void CACHE::handle_read()
 		      if (lower_level)
                         lower_level->add_rq(&RQ.entry[index]);
 		      else { // this is the last level
-                        if (cache_type == IS_STLB) {
+                        if (LEVEL == IS_STLB) {
 			  // TODO: need to differentiate page table walk and actual swap
 			  
 			  // emulate page table walk
@@ -696,6 +862,9 @@ void CACHE::handle_read()
                         // mark merged consumer
                         if (RQ.entry[index].type == RFO) {
 
+                            // a modified copy taken from another core stays dirty
+                            MSHR.entry[mshr_index].dirty |= RQ.entry[index].dirty;
+
                             if (RQ.entry[index].tlb_access) {
                                 uint32_t sq_index = RQ.entry[index].sq_index;
                                 MSHR.entry[mshr_index].store_merged = 1;
@@ -732,8 +901,12 @@ void CACHE::handle_read()
                             {
                                 uint32_t lq_index = RQ.entry[index].lq_index;
                                 MSHR.entry[mshr_index].is_data = 1; // add as data type
-                                MSHR.entry[mshr_index].load_merged = 1;
-                                MSHR.entry[mshr_index].lq_index_depend_on_me.insert (lq_index);
+                                if (!RQ.entry[index].wrong_path) {
+                                    MSHR.entry[mshr_index].load_merged = 1;
+                                    MSHR.entry[mshr_index].lq_index_depend_on_me.insert (lq_index);
+                                }
+                                else if (RQ.entry[index].load_merged) // the loads that merged with a wrong-path load
+                                    MSHR.entry[mshr_index].load_merged = 1;
 
                                 DP (if (warmup_complete[read_cpu]) {
                                 cout << "[DATA_MERGED] " << __func__ << " cpu: " << read_cpu << " instr_id: " << RQ.entry[index].instr_id;
@@ -761,6 +934,16 @@ void CACHE::handle_read()
 
                         // update request
                         if (MSHR.entry[mshr_index].type == PREFETCH) {
+                            if (pc_profile && (RQ.entry[index].type == LOAD) && (RQ.entry[index].instruction == 0))
+                                pc_profile->late_prefetch(read_cpu, LEVEL, RQ.entry[index].ip);
+                            if (fdp.enabled() && (RQ.entry[index].type != PREFETCH))
+                                fdp.prefetch_late();
+                            if (RQ.entry[index].type != PREFETCH) {
+                                pf_timeliness.late++;
+                                if (MSHR.entry[mshr_index].pf_source && (MSHR.entry[mshr_index].fill_level == fill_level))
+                                    MSHR.entry[mshr_index].pf_source->late++;
+                            }
+
                             uint8_t  prior_returned = MSHR.entry[mshr_index].returned;
                             uint64_t prior_event_cycle = MSHR.entry[mshr_index].event_cycle;
                             MSHR.entry[mshr_index] = RQ.entry[index];
@@ -786,20 +969,38 @@ void CACHE::handle_read()
                 }
 
                 if (miss_handled) {
+                    if ((LEVEL == IS_LLC) && partition)
+                        partition->observe(read_cpu, RQ.entry[index].address);
+
+                    if (pc_profile && (RQ.entry[index].type == LOAD) && (RQ.entry[index].instruction == 0))
+                        pc_profile->access(read_cpu, LEVEL, RQ.entry[index].ip, 0, 0);
+
+                    if (fdp.enabled() && (RQ.entry[index].type != PREFETCH))
+                        fdp.demand_miss(RQ.entry[index].address);
+
+                    if (reuse_profile.enabled())
+                        reuse_profile.access_block(RQ.entry[index].address, warmup_complete[read_cpu] && !simulation_complete[read_cpu]);
+
                     // update prefetcher on load instruction
 		    if (RQ.entry[index].type == LOAD) {
-		        if(cache_type == IS_L1I)
+		        if(LEVEL == IS_L1I)
 			  l1i_prefetcher_cache_operate(read_cpu, RQ.entry[index].ip, 0, 0);
-                        if (cache_type == IS_L1D) 
+                        if (LEVEL == IS_L1D) 
                             l1d_prefetcher_operate(RQ.entry[index].full_addr, RQ.entry[index].ip, 0, RQ.entry[index].type);
-                        if (cache_type == IS_L2C)
+                        if (LEVEL == IS_L2C)
 			  l2c_prefetcher_operate(RQ.entry[index].address<<LOG2_BLOCK_SIZE, RQ.entry[index].ip, 0, RQ.entry[index].type, 0);
-                        if (cache_type == IS_LLC)
+                        if (LEVEL == IS_LLC)
 			  {
 			    cpu = read_cpu;
 			    llc_prefetcher_operate(RQ.entry[index].address<<LOG2_BLOCK_SIZE, RQ.entry[index].ip, 0, RQ.entry[index].type, 0);
 			    cpu = 0;
 			  }
+                        if (prefetchers.size()) {
+                            cpu = read_cpu;
+                            prefetcher_operate(RQ.entry[index].address<<LOG2_BLOCK_SIZE, RQ.entry[index].ip, 0, RQ.entry[index].type);
+                            if (LEVEL == IS_LLC)
+                                cpu = 0;
+                        }
                     }
 
                     MISS[RQ.entry[index].type]++;
@@ -823,6 +1024,7 @@ void CACHE::handle_read()
     }
 }
 
+template <uint8_t LEVEL>
 void CACHE::handle_prefetch()
 {
     // handle prefetch
@@ -837,6 +1039,15 @@ void CACHE::handle_prefetch()
         if ((PQ.entry[PQ.head].event_cycle <= current_core_cycle[prefetch_cpu]) && (PQ.occupancy > 0)) {
             int index = PQ.head;
 
+            // shared address space: the directory resolves the other cores' copies first
+            if ((LEVEL == IS_LLC) && directory && (PQ.entry[index].fill_level < fill_level)) {
+                uint32_t coherence_delay = directory->handle_request(&PQ.entry[index]);
+                if (coherence_delay) {
+                    PQ.entry[index].event_cycle = current_core_cycle[prefetch_cpu] + coherence_delay;
+                    continue;
+                }
+            }
+
             // access cache
             uint32_t set = get_set(PQ.entry[index].address);
             int way = check_hit(&PQ.entry[index]);
@@ -844,7 +1055,7 @@ void CACHE::handle_prefetch()
             if (way >= 0) { // prefetch hit
 
                 // update replacement policy
-                if (cache_type == IS_LLC) {
+                if (LEVEL == IS_LLC) {
                     llc_update_replacement_state(prefetch_cpu, set, way, block[set][way].full_addr, PQ.entry[index].ip, 0, PQ.entry[index].type, 1);
 
                 }
@@ -855,19 +1066,37 @@ void CACHE::handle_prefetch()
                 sim_hit[prefetch_cpu][PQ.entry[index].type]++;
                 sim_access[prefetch_cpu][PQ.entry[index].type]++;
 
+                // nothing to bring in unless the prefetch is passing through to an upper level
+                if (PQ.entry[index].fill_level >= fill_level) {
+                    pf_timeliness.redundant++;
+                    if (PQ.entry[index].pf_source)
+                        PQ.entry[index].pf_source->redundant++;
+                }
+
+                // exclusive LLC: a hit moves the line up to the requester
+                uint8_t promote = (LEVEL == IS_LLC) && (inclusion_policy == EXCLUSIVE) && (PQ.entry[index].fill_level < fill_level);
+                if (promote)
+                    PQ.entry[index].dirty = block[set][way].dirty;
+
 		// run prefetcher on prefetches from higher caches
 		if(PQ.entry[index].pf_origin_level < fill_level)
 		  {
-		    if (cache_type == IS_L1D)
+		    if (LEVEL == IS_L1D)
 		      l1d_prefetcher_operate(PQ.entry[index].full_addr, PQ.entry[index].ip, 1, PREFETCH);
-                    else if (cache_type == IS_L2C)
+                    else if (LEVEL == IS_L2C)
                       PQ.entry[index].pf_metadata = l2c_prefetcher_operate(block[set][way].address<<LOG2_BLOCK_SIZE, PQ.entry[index].ip, 1, PREFETCH, PQ.entry[index].pf_metadata);
-                    else if (cache_type == IS_LLC)
+                    else if (LEVEL == IS_LLC)
 		      {
 			cpu = prefetch_cpu;
 			PQ.entry[index].pf_metadata = llc_prefetcher_operate(block[set][way].address<<LOG2_BLOCK_SIZE, PQ.entry[index].ip, 1, PREFETCH, PQ.entry[index].pf_metadata);
 			cpu = 0;
 		      }
+                    if (prefetchers.size()) {
+                        cpu = prefetch_cpu;
+                        prefetcher_operate(PQ.entry[index].address<<LOG2_BLOCK_SIZE, PQ.entry[index].ip, 1, PREFETCH);
+                        if (LEVEL == IS_LLC)
+                            cpu = 0;
+                    }
 		  }
 
                 // check fill level
@@ -893,6 +1122,12 @@ void CACHE::handle_prefetch()
 		    }
                 }
 
+                if (promote) {
+                    block[set][way].valid = 0;
+                    block[set][way].dirty = 0;
+                    exclusive_promotions++;
+                }
+
                 HIT[PQ.entry[index].type]++;
                 ACCESS[PQ.entry[index].type]++;
                 
@@ -912,6 +1147,10 @@ void CACHE::handle_prefetch()
                 uint8_t miss_handled = 1;
                 int mshr_index = check_mshr(&PQ.entry[index]);
 
+                // shared address space: wait for another core's miss to the same block to finish
+                if ((LEVEL == IS_LLC) && directory && (mshr_index >= 0) && (MSHR.entry[mshr_index].cpu != prefetch_cpu))
+                    mshr_index = -2;
+
 		if(mshr_index == -2)
 		  {
 		    // this is a data/instruction collision in the MSHR, so we have to wait before we can allocate this miss
@@ -927,7 +1166,7 @@ void CACHE::handle_prefetch()
                     // first check if the lower level PQ is full or not
                     // this is possible since multiple prefetchers can exist at each level of caches
                     if (lower_level) {
-		      if (cache_type == IS_LLC) {
+		      if (LEVEL == IS_LLC) {
 			if (lower_level->get_occupancy(1, PQ.entry[index].address) == lower_level->get_size(1, PQ.entry[index].address))
 			  miss_handled = 0;
 			else {
@@ -935,12 +1174,17 @@ void CACHE::handle_prefetch()
 			  // run prefetcher on prefetches from higher caches
 			  if(PQ.entry[index].pf_origin_level < fill_level)
 			    {
-			      if (cache_type == IS_LLC)
+			      if (LEVEL == IS_LLC)
 				{
 				  cpu = prefetch_cpu;
 				  PQ.entry[index].pf_metadata = llc_prefetcher_operate(PQ.entry[index].address<<LOG2_BLOCK_SIZE, PQ.entry[index].ip, 0, PREFETCH, PQ.entry[index].pf_metadata);
 				  cpu = 0;
 				}
+			      if (prefetchers.size()) {
+				  cpu = prefetch_cpu;
+				  prefetcher_operate(PQ.entry[index].address<<LOG2_BLOCK_SIZE, PQ.entry[index].ip, 0, PREFETCH);
+				  cpu = 0;
+			      }
 			    }
 			  
 			  // add it to MSHRs if this prefetch miss will be filled to this cache level
@@ -958,10 +1202,11 @@ void CACHE::handle_prefetch()
 			  // run prefetcher on prefetches from higher caches
 			  if(PQ.entry[index].pf_origin_level < fill_level)
 			    {
-			      if (cache_type == IS_L1D)
+			      if (LEVEL == IS_L1D)
 				l1d_prefetcher_operate(PQ.entry[index].full_addr, PQ.entry[index].ip, 0, PREFETCH);
-			      if (cache_type == IS_L2C)
+			      if (LEVEL == IS_L2C)
 				PQ.entry[index].pf_metadata = l2c_prefetcher_operate(PQ.entry[index].address<<LOG2_BLOCK_SIZE, PQ.entry[index].ip, 0, PREFETCH, PQ.entry[index].pf_metadata);
+			      prefetcher_operate(PQ.entry[index].address<<LOG2_BLOCK_SIZE, PQ.entry[index].ip, 0, PREFETCH);
 			    }
 			  
 			  // add it to MSHRs if this prefetch miss will be filled to this cache level
@@ -1042,20 +1287,34 @@ void CACHE::handle_prefetch()
     }
 }
 
-void CACHE::operate()
+template <uint8_t LEVEL>
+void CACHE::operate_level()
 {
-    handle_fill();
-    handle_writeback();
+    handle_fill<LEVEL>();
+    handle_writeback<LEVEL>();
     reads_available_this_cycle = MAX_READ;
-    handle_read();
+    handle_read<LEVEL>();
 
-    if (PQ.occupancy && (reads_available_this_cycle > 0))
-        handle_prefetch();
+    // TLBs never issue prefetches, so their PQ is not even looked at
+    if (!is_tlb_level(LEVEL) && PQ.occupancy && (reads_available_this_cycle > 0))
+        handle_prefetch<LEVEL>();
 }
 
-uint32_t CACHE::get_set(uint64_t address)
+void CACHE::operate()
 {
-    return (uint32_t) (address & ((1 << lg2(NUM_SET)) - 1)); 
+    // dispatch once per cycle to the level-specialized pipeline
+    switch (cache_type) {
+        case IS_ITLB: operate_level<IS_ITLB>(); break;
+        case IS_DTLB: operate_level<IS_DTLB>(); break;
+        case IS_STLB: operate_level<IS_STLB>(); break;
+        case IS_L1I:  operate_level<IS_L1I>();  break;
+        case IS_L1D:  operate_level<IS_L1D>();  break;
+        case IS_L2C:  operate_level<IS_L2C>();  break;
+        case IS_LLC:  operate_level<IS_LLC>();  break;
+        default:
+            cerr << "[" << NAME << "] unknown cache_type: " << +cache_type << endl;
+            assert(0);
+    }
 }
 
 uint32_t CACHE::get_way(uint64_t address, uint32_t set)
@@ -1086,8 +1345,18 @@ void CACHE::fill_cache(uint32_t set, uint32_t way, PACKET *packet)
             assert(0);
     }
 #endif
-    if (block[set][way].prefetch && (block[set][way].used == 0))
+    if (block[set][way].prefetch && (block[set][way].used == 0)) {
         pf_useless++;
+        pf_timeliness.useless++;
+        if (block[set][way].pf_source)
+            block[set][way].pf_source->useless++;
+    }
+
+    if (fdp.enabled()) {
+        int32_t throttle = fdp.fill(packet->address, packet->type == PREFETCH, block[set][way].valid, block[set][way].address);
+        if (throttle)
+            prefetcher_throttle(throttle);
+    }
 
     if (block[set][way].valid == 0)
         block[set][way].valid = 1;
@@ -1097,6 +1366,8 @@ void CACHE::fill_cache(uint32_t set, uint32_t way, PACKET *packet)
 
     if (block[set][way].prefetch)
         pf_fill++;
+    block[set][way].pf_source = (block[set][way].prefetch && (packet->fill_level == fill_level)) ? packet->pf_source : NULL;
+    block[set][way].fill_cycle = current_core_cycle[packet->cpu];
 
     block[set][way].delta = packet->delta;
     block[set][way].depth = packet->depth;
@@ -1179,6 +1450,73 @@ int CACHE::invalidate_entry(uint64_t inval_addr)
     return match_way;
 }
 
+// drop inval_addr from every cache above this one, returns how many copies were removed
+static uint32_t invalidate_above(CACHE *cache, uint64_t inval_addr, uint8_t &dirty)
+{
+    uint32_t removed = 0;
+
+    for (uint32_t i=0; i<NUM_CPUS; i++) {
+        CACHE *upper[2] = {(CACHE *) cache->upper_level_icache[i], (CACHE *) cache->upper_level_dcache[i]};
+
+        for (uint32_t j=0; j<2; j++) {
+            if ((upper[j] == NULL) || ((j == 1) && (upper[1] == upper[0])))
+                continue;
+
+            // clear the levels above first so the whole hierarchy stays inclusive
+            removed += invalidate_above(upper[j], inval_addr, dirty);
+
+            int way = upper[j]->invalidate_entry(inval_addr);
+            if (way >= 0) {
+                uint32_t set = upper[j]->get_set(inval_addr);
+                if (upper[j]->block[set][way].dirty) {
+                    dirty = 1;
+                    upper[j]->block[set][way].dirty = 0;
+                }
+                removed++;
+            }
+        }
+    }
+
+    return removed;
+}
+
+uint8_t CACHE::back_invalidate(uint64_t inval_addr)
+{
+    // returns 1 if one of the dropped copies was dirty
+    uint8_t dirty = 0;
+    back_invalidations += invalidate_above(this, inval_addr, dirty);
+
+    return dirty;
+}
+
+// collect the addresses of all valid blocks in this cache and every level above it
+static void collect_resident_blocks(CACHE *cache, set<uint64_t> &unique)
+{
+    for (uint32_t i=0; i<cache->NUM_SET; i++) {
+        for (uint32_t j=0; j<cache->NUM_WAY; j++) {
+            if (cache->block[i][j].valid)
+                unique.insert(cache->block[i][j].address);
+        }
+    }
+
+    for (uint32_t i=0; i<NUM_CPUS; i++) {
+        CACHE *upper[2] = {(CACHE *) cache->upper_level_icache[i], (CACHE *) cache->upper_level_dcache[i]};
+        for (uint32_t j=0; j<2; j++) {
+            if ((upper[j] != NULL) && !((j == 1) && (upper[1] == upper[0])))
+                collect_resident_blocks(upper[j], unique);
+        }
+    }
+}
+
+uint64_t CACHE::effective_capacity()
+{
+    // distinct blocks held by this level and the levels above it
+    set<uint64_t> unique;
+    collect_resident_blocks(this, unique);
+
+    return unique.size();
+}
+
 int CACHE::add_rq(PACKET *packet)
 {
     // check for the latest wirtebacks in the write queue
@@ -1188,6 +1526,10 @@ int CACHE::add_rq(PACKET *packet)
         // check fill level
         if (packet->fill_level < fill_level) {
 
+            // the forwarded copy still has to be tracked (the latency of any coherence action is not modeled here)
+            if ((cache_type == IS_LLC) && directory)
+                directory->handle_request(packet);
+
             packet->data = WQ.entry[wq_index].data;
 
 	    if(fill_level == FILL_L2)
@@ -1261,7 +1603,7 @@ int CACHE::add_rq(PACKET *packet)
                 RQ.entry[index].sq_index_depend_on_me.insert (sq_index);
                 RQ.entry[index].store_merged = 1;
             }
-            else {
+            else if (!packet->wrong_path) {
                 uint32_t lq_index = packet->lq_index; 
                 RQ.entry[index].lq_index_depend_on_me.insert (lq_index);
                 RQ.entry[index].load_merged = 1;
@@ -1390,9 +1732,21 @@ int CACHE::prefetch_line(uint64_t ip, uint64_t base_addr, uint64_t pf_addr, int
 {
     pf_requested++;
 
+    PF_TIMELINESS *source = pf_issuer ? pf_issuer : &pf_base_timeliness;
+    if (PQ.occupancy == PQ.SIZE) {
+        pf_timeliness.dropped++;
+        source->dropped++;
+    }
+    else if ((base_addr>>LOG2_PAGE_SIZE) != (pf_addr>>LOG2_PAGE_SIZE)) {
+        pf_timeliness.cross_page++;
+        source->cross_page++;
+    }
+
     if (PQ.occupancy < PQ.SIZE) {
         if ((base_addr>>LOG2_PAGE_SIZE) == (pf_addr>>LOG2_PAGE_SIZE)) {
-            
+            if (filter_prefetch(pf_addr))
+                return 0;
+
             PACKET pf_packet;
             pf_packet.fill_level = pf_fill_level;
 	    pf_packet.pf_origin_level = fill_level;
@@ -1411,11 +1765,14 @@ int CACHE::prefetch_line(uint64_t ip, uint64_t base_addr, uint64_t pf_addr, int
             pf_packet.ip = ip;
             pf_packet.type = PREFETCH;
             pf_packet.event_cycle = current_core_cycle[cpu];
+            pf_packet.pf_source = source;
 
             // give a dummy 0 as the IP of a prefetch
             add_pq(&pf_packet);
 
             pf_issued++;
+            pf_timeliness.issued++;
+            source->issued++;
 
             return 1;
         }
@@ -1426,9 +1783,21 @@ int CACHE::prefetch_line(uint64_t ip, uint64_t base_addr, uint64_t pf_addr, int
 
 int CACHE::kpc_prefetch_line(uint64_t base_addr, uint64_t pf_addr, int pf_fill_level, int delta, int depth, int signature, int confidence, uint32_t prefetch_metadata)
 {
+    PF_TIMELINESS *source = pf_issuer ? pf_issuer : &pf_base_timeliness;
+    if (PQ.occupancy == PQ.SIZE) {
+        pf_timeliness.dropped++;
+        source->dropped++;
+    }
+    else if ((base_addr>>LOG2_PAGE_SIZE) != (pf_addr>>LOG2_PAGE_SIZE)) {
+        pf_timeliness.cross_page++;
+        source->cross_page++;
+    }
+
     if (PQ.occupancy < PQ.SIZE) {
         if ((base_addr>>LOG2_PAGE_SIZE) == (pf_addr>>LOG2_PAGE_SIZE)) {
-            
+            if (filter_prefetch(pf_addr))
+                return 0;
+
             PACKET pf_packet;
             pf_packet.fill_level = pf_fill_level;
 	    pf_packet.pf_origin_level = fill_level;
@@ -1451,11 +1820,14 @@ int CACHE::kpc_prefetch_line(uint64_t base_addr, uint64_t pf_addr, int pf_fill_l
             pf_packet.signature = signature;
             pf_packet.confidence = confidence;
             pf_packet.event_cycle = current_core_cycle[cpu];
+            pf_packet.pf_source = source;
 
             // give a dummy 0 as the IP of a prefetch
             add_pq(&pf_packet);
 
             pf_issued++;
+            pf_timeliness.issued++;
+            source->issued++;
 
             return 1;
         }
@@ -1473,6 +1845,10 @@ int CACHE::add_pq(PACKET *packet)
         // check fill level
         if (packet->fill_level < fill_level) {
 
+            // the forwarded copy still has to be tracked (the latency of any coherence action is not modeled here)
+            if ((cache_type == IS_LLC) && directory)
+                directory->handle_request(packet);
+
             packet->data = WQ.entry[wq_index].data;
 
 	    if(fill_level == FILL_L2)
@@ -1603,6 +1979,8 @@ void CACHE::return_data(PACKET *packet)
     MSHR.entry[mshr_index].returned = COMPLETED;
     MSHR.entry[mshr_index].data = packet->data;
     MSHR.entry[mshr_index].pf_metadata = packet->pf_metadata;
+    MSHR.entry[mshr_index].dirty |= packet->dirty;
+    MSHR.entry[mshr_index].coherence_miss = packet->coherence_miss;
 
     // ADD LATENCY
     if (MSHR.entry[mshr_index].event_cycle < current_core_cycle[packet->cpu])
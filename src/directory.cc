@@ -0,0 +1,269 @@
+#include "directory.h"
+
+DIRECTORY_ENTRY *DIRECTORY::find_entry(uint64_t address)
+{
+    uint32_t set = address % DIR_SET;
+
+    for (uint32_t way=0; way<DIR_WAY; way++) {
+        if (entry[set][way].valid && (entry[set][way].address == address)) {
+            update_lru(set, way);
+            return &entry[set][way];
+        }
+    }
+
+    return NULL;
+}
+
+DIRECTORY_ENTRY *DIRECTORY::allocate_entry(uint64_t address)
+{
+    uint32_t set = address % DIR_SET, way;
+
+    // fill invalid entry first, otherwise replace the LRU entry
+    for (way=0; way<DIR_WAY; way++) {
+        if (entry[set][way].valid == 0)
+            break;
+    }
+
+    if (way == DIR_WAY) {
+        for (way=0; way<DIR_WAY; way++) {
+            if (entry[set][way].lru == DIR_WAY-1)
+                break;
+        }
+
+#ifdef SANITY_CHECK
+        if (way == DIR_WAY) {
+            cerr << "[" << NAME << "] " << __func__ << " no victim! set: " << set << endl;
+            assert(0);
+        }
+#endif
+
+        // a sparse directory cannot forget a block, so every copy of the victim is recalled
+        DIRECTORY_ENTRY *victim = &entry[set][way];
+        for (uint32_t i=0; i<NUM_CPUS; i++) {
+            if ((victim->sharers & (1ull << i)) == 0)
+                continue;
+
+            uint8_t dirty = 0;
+            if (invalidate_copies(i, victim->address, dirty)) {
+                recall++;
+                if (dirty)
+                    write_back(i, victim->address);
+            }
+        }
+    }
+
+    uint32_t lru = entry[set][way].lru;
+    entry[set][way] = DIRECTORY_ENTRY();
+    entry[set][way].valid = 1;
+    entry[set][way].address = address;
+    entry[set][way].lru = lru;
+    update_lru(set, way);
+
+    return &entry[set][way];
+}
+
+void DIRECTORY::update_lru(uint32_t set, uint32_t way)
+{
+    for (uint32_t i=0; i<DIR_WAY; i++) {
+        if (entry[set][i].lru < entry[set][way].lru)
+            entry[set][i].lru++;
+    }
+    entry[set][way].lru = 0;
+}
+
+uint8_t DIRECTORY::invalidate_copies(uint32_t cpu, uint64_t address, uint8_t &dirty)
+{
+    // returns 1 if the core really held the block (sharer bits can be stale after silent evictions)
+    uint8_t found = 0;
+    CACHE *copy[2] = {L1D[cpu], L2C[cpu]};
+
+    for (uint32_t i=0; i<2; i++) {
+        int way = copy[i]->invalidate_entry(address);
+        if (way < 0)
+            continue;
+
+        uint32_t set = copy[i]->get_set(address);
+        if (copy[i]->block[set][way].dirty) {
+            dirty = 1;
+            copy[i]->block[set][way].dirty = 0;
+        }
+        found = 1;
+    }
+
+    return found;
+}
+
+uint8_t DIRECTORY::downgrade_copies(uint32_t cpu, uint64_t address)
+{
+    // M/E -> S, dirty data goes back to the LLC
+    uint8_t found = 0, dirty = 0;
+    CACHE *copy[2] = {L1D[cpu], L2C[cpu]};
+    BLOCK *line[2] = {NULL, NULL};
+
+    for (uint32_t i=0; i<2; i++) {
+        uint32_t set = copy[i]->get_set(address),
+                 way = copy[i]->get_way(address, set);
+        if (way == copy[i]->NUM_WAY)
+            continue;
+
+        line[i] = &copy[i]->block[set][way];
+        dirty |= line[i]->dirty;
+        found = 1;
+    }
+
+    // if the LLC cannot take the data right now the owner keeps it dirty (like MOESI O)
+    if (dirty && write_back(cpu, address)) {
+        for (uint32_t i=0; i<2; i++) {
+            if (line[i])
+                line[i]->dirty = 0;
+        }
+    }
+
+    return found;
+}
+
+uint8_t DIRECTORY::write_back(uint32_t cpu, uint64_t address)
+{
+    uint32_t set = LLC->get_set(address),
+             way = LLC->get_way(address, set);
+
+    if (way < LLC->NUM_WAY) {
+        LLC->block[set][way].dirty = 1;
+        coherence_writeback++;
+        return 1;
+    }
+
+    if (LLC->WQ.occupancy < LLC->WQ.SIZE) {
+        PACKET writeback_packet;
+
+        writeback_packet.fill_level = FILL_LLC;
+        writeback_packet.cpu = cpu;
+        writeback_packet.address = address;
+        writeback_packet.full_addr = address << LOG2_BLOCK_SIZE;
+        writeback_packet.dirty = 1;
+        writeback_packet.ip = 0;
+        writeback_packet.type = WRITEBACK;
+        writeback_packet.event_cycle = current_core_cycle[cpu];
+
+        LLC->add_wq(&writeback_packet);
+        coherence_writeback++;
+        return 1;
+    }
+
+    return 0;
+}
+
+uint32_t DIRECTORY::handle_request(PACKET *packet)
+{
+    // code is read-only and is not tracked, and a request back from its coherence delay is done
+    if ((packet->instruction && !packet->is_data) || packet->coherence_resolved)
+        return 0;
+    packet->coherence_resolved = 1;
+
+    uint32_t cpu = packet->cpu;
+    uint64_t address = packet->address,
+             requester = 1ull << cpu;
+    uint8_t  forwarded = 0;
+
+    lookup++;
+    DIRECTORY_ENTRY *dir = find_entry(address);
+    if (dir == NULL)
+        dir = allocate_entry(address);
+
+    if (packet->type == RFO) {
+
+        // the upper levels flag a store to a shared copy as an upgrade miss
+        if (packet->coherence_miss && !((dir->state == DIR_EXCLUSIVE) && (dir->owner == cpu)))
+            upgrade[cpu]++;
+
+        // every other copy is invalidated, dirty data travels to the new owner with the response
+        uint8_t dirty = 0;
+        for (uint32_t i=0; i<NUM_CPUS; i++) {
+            if ((i == cpu) || ((dir->sharers & (1ull << i)) == 0))
+                continue;
+
+            if (invalidate_copies(i, address, dirty)) {
+                invalidation[i]++;
+                dir->invalidated |= (1ull << i);
+                forwarded = 1;
+            }
+        }
+        if (dirty)
+            packet->dirty = 1;
+
+        dir->state = DIR_EXCLUSIVE;
+        dir->owner = cpu;
+        dir->sharers = requester;
+    }
+    else {
+
+        // a read of a block another core owns downgrades the owner to S
+        if ((dir->state == DIR_EXCLUSIVE) && (dir->owner != cpu)) {
+            if (downgrade_copies(dir->owner, address)) {
+                downgrade[dir->owner]++;
+                forwarded = 1;
+            }
+        }
+
+        dir->sharers |= requester;
+        if (dir->sharers == requester) {
+            dir->state = DIR_EXCLUSIVE;
+            dir->owner = cpu;
+        }
+        else
+            dir->state = DIR_SHARED;
+    }
+
+    // this core is coming back for a block another core's write took away
+    if (dir->invalidated & requester) {
+        dir->invalidated &= ~requester;
+        packet->coherence_miss = 1;
+        coherence_miss[cpu]++;
+    }
+
+    DP ( if (warmup_complete[cpu]) {
+    cout << "[" << NAME << "] " << __func__ << " cpu: " << cpu << " type: " << +packet->type << " address: " << hex << address << dec;
+    cout << " state: " << +dir->state << " owner: " << dir->owner << " sharers: " << hex << dir->sharers << dec;
+    cout << " forwarded: " << +forwarded << endl; });
+
+    return forwarded ? COHERENCE_LATENCY : 0;
+}
+
+uint8_t DIRECTORY::is_owner(uint32_t cpu, uint64_t address)
+{
+    uint32_t set = address % DIR_SET;
+
+    for (uint32_t way=0; way<DIR_WAY; way++) {
+        if (entry[set][way].valid && (entry[set][way].address == address))
+            return (entry[set][way].state == DIR_EXCLUSIVE) && (entry[set][way].owner == cpu);
+    }
+
+    return 0;
+}
+
+void DIRECTORY::reset_stats()
+{
+    lookup = 0;
+    recall = 0;
+    coherence_writeback = 0;
+
+    for (uint32_t i=0; i<NUM_CPUS; i++) {
+        invalidation[i] = 0;
+        downgrade[i] = 0;
+        upgrade[i] = 0;
+        coherence_miss[i] = 0;
+    }
+}
+
+void DIRECTORY::print_stats()
+{
+    cout << endl;
+    cout << "Directory Statistics" << endl;
+    cout << " LOOKUP: " << setw(10) << lookup << "  RECALL: " << setw(10) << recall;
+    cout << "  COHERENCE_WRITEBACK: " << setw(10) << coherence_writeback << endl;
+
+    for (uint32_t i=0; i<NUM_CPUS; i++) {
+        cout << " CPU " << i << " INVALIDATION: " << setw(10) << invalidation[i] << "  DOWNGRADE: " << setw(10) << downgrade[i];
+        cout << "  UPGRADE: " << setw(10) << upgrade[i] << "  COHERENCE_MISS: " << setw(10) << coherence_miss[i] << endl;
+    }
+}
@@ -257,6 +257,10 @@ void MEMORY_CONTROLLER::schedule(PACKET_QUEUE *queue)
         queue->entry[oldest_index].scheduled = 1;
         queue->entry[oldest_index].event_cycle = current_core_cycle[op_cpu] + LATENCY;
 
+        bank_request[op_channel][op_rank][op_bank].cycle_scheduled = current_core_cycle[op_cpu];
+        if (queue->is_RQ && warmup_complete[op_cpu] && !simulation_complete[op_cpu])
+            read_queue_latency.add(current_core_cycle[op_cpu] - queue->entry[oldest_index].cycle_enqueued);
+
         update_schedule_cycle(queue);
         update_process_cycle(queue);
 
@@ -323,6 +327,9 @@ void MEMORY_CONTROLLER::process(PACKET_QUEUE *queue)
                 dbus_cycle_available[op_channel] = current_core_cycle[op_cpu] + DRAM_DBUS_RETURN_TIME;
                 queue->entry[request_index].event_cycle = dbus_cycle_available[op_channel]; 
 
+                if (warmup_complete[op_cpu] && !simulation_complete[op_cpu])
+                    read_service_latency.add(dbus_cycle_available[op_channel] - bank_request[op_channel][op_rank][op_bank].cycle_scheduled);
+
                 DP ( if (warmup_complete[op_cpu]) {
                 cout << "[" << queue->NAME << "] " <<  __func__ << " return data" << hex;
                 cout << " address: " << queue->entry[request_index].address << " full_addr: " << queue->entry[request_index].full_addr << dec;
@@ -464,6 +471,7 @@ int MEMORY_CONTROLLER::add_rq(PACKET *packet)
         if (RQ[channel].entry[index].address == 0) {
             
             RQ[channel].entry[index] = *packet;
+            RQ[channel].entry[index].cycle_enqueued = current_core_cycle[packet->cpu];
             RQ[channel].occupancy++;
 
 #ifdef DEBUG_PRINT
@@ -506,6 +514,7 @@ int MEMORY_CONTROLLER::add_wq(PACKET *packet)
         if (WQ[channel].entry[index].address == 0) {
             
             WQ[channel].entry[index] = *packet;
+            WQ[channel].entry[index].cycle_enqueued = current_core_cycle[packet->cpu];
             WQ[channel].occupancy++;
 
 #ifdef DEBUG_PRINT
@@ -0,0 +1,116 @@
+#include "fdp.h"
+
+void FDP::init(uint32_t fills_per_interval)
+{
+    interval = fills_per_interval;
+    init_state();
+    reset_stats();
+}
+
+void FDP::init_state()
+{
+    for (uint32_t i=0; i<FDP_BLOOM_BITS/64; i++)
+        bloom[i] = 0;
+
+    fills = 0;
+    sent = 0;
+    used = 0;
+    late = 0;
+    misses = 0;
+    pollution = 0;
+
+    avg_sent = 0;
+    avg_used = 0;
+    avg_late = 0;
+    avg_misses = 0;
+    avg_pollution = 0;
+}
+
+void FDP::demand_miss(uint64_t address)
+{
+    misses++;
+
+    uint32_t bit = hash(address);
+    if (bloom[bit/64] & (1ull << (bit%64)))
+        pollution++;
+}
+
+int32_t FDP::fill(uint64_t address, uint8_t prefetch, uint8_t victim_valid, uint64_t victim_addr)
+{
+    // the block is back, so it no longer counts as a prefetch victim
+    uint32_t bit = hash(address);
+    bloom[bit/64] &= ~(1ull << (bit%64));
+
+    if (prefetch) {
+        sent++;
+        if (victim_valid) {
+            bit = hash(victim_addr);
+            bloom[bit/64] |= (1ull << (bit%64));
+        }
+    }
+
+    if (++fills < interval)
+        return 0;
+
+    return decide();
+}
+
+int32_t FDP::decide()
+{
+    avg_sent = (avg_sent + sent) / 2;
+    avg_used = (avg_used + used) / 2;
+    avg_late = (avg_late + late) / 2;
+    avg_misses = (avg_misses + misses) / 2;
+    avg_pollution = (avg_pollution + pollution) / 2;
+
+    fills = 0;
+    sent = 0;
+    used = 0;
+    late = 0;
+    misses = 0;
+    pollution = 0;
+
+    double accuracy = avg_sent ? ((double) avg_used / avg_sent) : 0;
+    uint8_t is_late = avg_used && (((double) avg_late / avg_used) > FDP_LATENESS),
+            polluting = avg_misses && (((double) avg_pollution / avg_misses) > FDP_POLLUTION);
+
+    // table 2 of the paper: late prefetches call for more aggressive prefetching unless they
+    // are inaccurate or (at medium accuracy) polluting, and polluting prefetches for less
+    int32_t decision = 0;
+    if (accuracy >= FDP_ACCURACY_HIGH)
+        decision = is_late ? 1 : (polluting ? -1 : 0);
+    else if (accuracy >= FDP_ACCURACY_LOW)
+        decision = is_late ? (polluting ? -1 : 1) : (polluting ? -1 : 0);
+    else
+        decision = (is_late || polluting) ? -1 : 0;
+
+    intervals++;
+    if (decision > 0)
+        increase++;
+    if (decision < 0)
+        decrease++;
+
+    DP ( if (warmup_complete[0]) {
+    cout << "[FDP] " << __func__ << " accuracy: " << accuracy << " late: " << +is_late << " polluting: " << +polluting;
+    cout << " decision: " << decision << endl; });
+
+    return decision;
+}
+
+void FDP::reset_stats()
+{
+    intervals = 0;
+    increase = 0;
+    decrease = 0;
+}
+
+void FDP::print_stats(string name)
+{
+    if (!enabled())
+        return;
+
+    cout << name << " FDP  INTERVALS: " << setw(10) << intervals << "  INCREASE: " << setw(10) << increase << "  DECREASE: " << setw(10) << decrease;
+    cout << "  ACCURACY: " << (avg_sent ? ((double) avg_used / avg_sent) : 0);
+    cout << "  LATENESS: " << (avg_used ? ((double) avg_late / avg_used) : 0);
+    cout << "  POLLUTION: " << (avg_misses ? ((double) avg_pollution / avg_misses) : 0) << endl;
+}
@@ -0,0 +1,42 @@
+#include "histogram.h"
+
+void LOG_HISTOGRAM::reset()
+{
+    count = 0;
+    sum = 0;
+    max = 0;
+    for (uint32_t i=0; i<HISTOGRAM_BUCKETS; i++)
+        bucket[i] = 0;
+}
+
+uint64_t LOG_HISTOGRAM::percentile(double p)
+{
+    if (count == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t) (p * count),
+             seen = 0;
+    if (rank == 0)
+        rank = 1;
+
+    for (uint32_t i=0; i<HISTOGRAM_BUCKETS; i++) {
+        seen += bucket[i];
+        if (seen >= rank) {
+            if (i == (HISTOGRAM_BUCKETS - 1))
+                return max;
+
+            uint64_t upper = floor(i+1) - 1;
+            return (upper < max) ? upper : max;
+        }
+    }
+
+    return max;
+}
+
+void LOG_HISTOGRAM::print(string name)
+{
+    cout << name << "  COUNT: " << setw(10) << count << "  AVERAGE: " << setw(8) << (count ? ((double) sum / count) : 0);
+    cout << "  P50: " << setw(6) << percentile(0.5) << "  P90: " << setw(6) << percentile(0.9);
+    cout << "  P99: " << setw(6) << percentile(0.99) << "  P99.9: " << setw(6) << percentile(0.999);
+    cout << "  MAX: " << setw(6) << max << " cycles" << endl;
+}
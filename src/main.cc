@@ -3,7 +3,7 @@
 #include <getopt.h>
 #include "ooo_cpu.h"
 #include "uncore.h"
-#include <fstream>
+#include "prefetcher.h"
 
 uint8_t warmup_complete[NUM_CPUS], 
         simulation_complete[NUM_CPUS], 
@@ -11,7 +11,17 @@ uint8_t warmup_complete[NUM_CPUS],
         all_simulation_complete = 0,
         MAX_INSTR_DESTINATIONS = NUM_INSTR_DESTINATIONS,
         knob_cloudsuite = 0,
-        knob_low_bandwidth = 0;
+        knob_low_bandwidth = 0,
+        knob_shared_address_space = 0,
+        knob_llc_partition = 0,
+        knob_pc_profile = 0,
+        knob_fdp = 0,
+        knob_btb = 0,
+        knob_wrong_path = 0,
+        knob_wrong_path_loads = 0,
+        knob_uop_cache = 0;
+
+uint32_t knob_reuse_profile = 0; // SHARDS sampling rate, 0 is off and 1 exact
 
 uint64_t warmup_instructions     = 1000000,
          simulation_instructions = 10000000,
@@ -63,8 +73,31 @@ void print_roi_stats(uint32_t cpu, CACHE *cache)
     cout << " PREFETCH  REQUESTED: " << setw(10) << cache->pf_requested << "  ISSUED: " << setw(10) << cache->pf_issued;
     cout << "  USEFUL: " << setw(10) << cache->pf_useful << "  USELESS: " << setw(10) << cache->pf_useless << endl;
 
+    cache->pf_timeliness.print(cache->NAME + " PREFETCH");
+
     cout << cache->NAME;
     cout << " AVERAGE MISS LATENCY: " << (1.0*(cache->total_miss_latency))/TOTAL_MISS << " cycles" << endl;
+
+    cache->mshr_residency.print(cache->NAME + " MSHR RESIDENCY");
+
+    if (cache->directory && (cache->cache_type != IS_LLC)) {
+        cout << cache->NAME;
+        cout << " COHERENCE MISS: " << setw(10) << cache->coherence_misses << "  AVERAGE LATENCY: ";
+        cout << (1.0*(cache->coherence_miss_latency))/cache->coherence_misses << " cycles" << endl;
+    }
+
+    if (cache->upper_level_dcache[cpu]) {
+        const char *inclusion_name[] = {"NON_INCLUSIVE", "INCLUSIVE", "EXCLUSIVE"};
+        uint64_t resident = cache->effective_capacity();
+
+        cout << cache->NAME;
+        cout << " " << inclusion_name[cache->inclusion_policy] << "  BACK_INVALIDATION: " << setw(10) << cache->back_invalidations;
+        cout << "  VICTIM_FILL: " << setw(10) << cache->exclusive_victim_fills << "  PROMOTION: " << setw(10) << cache->exclusive_promotions << endl;
+
+        cout << cache->NAME;
+        cout << " EFFECTIVE CAPACITY: " << resident << " blocks (" << (resident*BLOCK_SIZE)/1024 << " KB, ";
+        cout << (100.0*resident)/cache->NUM_LINE << "% of " << cache->NUM_LINE << " lines)" << endl;
+    }
     //cout << " AVERAGE MISS LATENCY: " << (cache->total_miss_latency)/TOTAL_MISS << " cycles " << cache->total_miss_latency << "/" << TOTAL_MISS<< endl;
 }
 
@@ -111,6 +144,21 @@ void print_branch_stats()
 	cout << "BRANCH_INDIRECT_CALL: " << ooo_cpu[i].total_branch_types[5] << " " << (100.0*ooo_cpu[i].total_branch_types[5])/(ooo_cpu[i].num_retired - ooo_cpu[i].begin_sim_instr) << "%" << endl;
 	cout << "BRANCH_RETURN: " << ooo_cpu[i].total_branch_types[6] << " " << (100.0*ooo_cpu[i].total_branch_types[6])/(ooo_cpu[i].num_retired - ooo_cpu[i].begin_sim_instr) << "%" << endl;
 	cout << "BRANCH_OTHER: " << ooo_cpu[i].total_branch_types[7] << " " << (100.0*ooo_cpu[i].total_branch_types[7])/(ooo_cpu[i].num_retired - ooo_cpu[i].begin_sim_instr) << "%" << endl << endl;
+
+        if (knob_btb) {
+            ooo_cpu[i].btb.print_stats(i);
+            cout << endl;
+        }
+
+        if (knob_wrong_path) {
+            ooo_cpu[i].wrong_path.print_stats(i);
+            cout << endl;
+        }
+
+        if (knob_uop_cache) {
+            ooo_cpu[i].uop_cache.print_stats(i);
+            cout << endl;
+        }
     }
 }
 
@@ -134,6 +182,9 @@ void print_dram_stats()
         cout << " AVG_CONGESTED_CYCLE: " << (total_congested_cycle / uncore.DRAM.dbus_congested[NUM_TYPES][NUM_TYPES]) << endl;
     else
         cout << " AVG_CONGESTED_CYCLE: -" << endl;
+
+    uncore.DRAM.read_queue_latency.print(" RQ QUEUEING");
+    uncore.DRAM.read_service_latency.print(" RQ SERVICE ");
 }
 
 void reset_cache_stats(uint32_t cpu, CACHE *cache)
@@ -151,6 +202,22 @@ void reset_cache_stats(uint32_t cpu, CACHE *cache)
     }
 
     cache->total_miss_latency = 0;
+    cache->mshr_residency.reset();
+
+    cache->reuse_profile.reset_stats();
+    cache->fdp.reset_stats();
+
+    cache->pf_timeliness.reset();
+    cache->pf_base_timeliness.reset();
+    for (uint32_t i=0; i<cache->prefetchers.size(); i++)
+        cache->prefetchers[i]->timeliness.reset();
+
+    cache->coherence_misses = 0;
+    cache->coherence_miss_latency = 0;
+
+    cache->back_invalidations = 0;
+    cache->exclusive_victim_fills = 0;
+    cache->exclusive_promotions = 0;
 
     cache->RQ.ACCESS = 0;
     cache->RQ.MERGED = 0;
@@ -191,7 +258,11 @@ void finish_warmup()
         // reset branch stats
         ooo_cpu[i].num_branch = 0;
         ooo_cpu[i].branch_mispredictions = 0;
+        ooo_cpu[i].btb.reset_stats();
+        ooo_cpu[i].wrong_path.reset_stats();
+        ooo_cpu[i].uop_cache.reset_stats();
 	ooo_cpu[i].total_rob_occupancy_at_branch_mispredict = 0;
+        ooo_cpu[i].load_latency.reset();
 
 	for(uint32_t j=0; j<8; j++)
 	  {
@@ -202,7 +273,10 @@ void finish_warmup()
         reset_cache_stats(i, &ooo_cpu[i].L1D);
         reset_cache_stats(i, &ooo_cpu[i].L2C);
         reset_cache_stats(i, &uncore.LLC);
+        uncore.directory.reset_stats();
+        uncore.partition.reset_stats();
     }
+    uncore.pc_profile.reset_stats();
     cout << endl;
 
     // reset DRAM stats
@@ -212,6 +286,8 @@ void finish_warmup()
         uncore.DRAM.WQ[i].ROW_BUFFER_HIT = 0;
         uncore.DRAM.WQ[i].ROW_BUFFER_MISS = 0;
     }
+    uncore.DRAM.read_queue_latency.reset();
+    uncore.DRAM.read_service_latency.reset();
 
     // set actual cache latency
     for (uint32_t i=0; i<NUM_CPUS; i++) {
@@ -305,7 +381,9 @@ uint64_t va_to_pa(uint32_t cpu, uint64_t instr_id, uint64_t va, uint64_t unique_
 #endif
 
     uint8_t  swap = 0;
-    uint64_t high_bit_mask = rotr64(cpu, lg2(NUM_CPUS)),
+
+    // threads of one process share a page table, otherwise every cpu gets its own address space
+    uint64_t high_bit_mask = knob_shared_address_space ? 0 : rotr64(cpu, lg2(NUM_CPUS)),
              unique_va = va | high_bit_mask;
     //uint64_t vpage = unique_va >> LOG2_PAGE_SIZE,
     uint64_t vpage = unique_vpage | high_bit_mask,
@@ -377,14 +455,23 @@ uint64_t va_to_pa(uint32_t cpu, uint64_t instr_id, uint64_t va, uint64_t unique_
             page_queue.push(vpage);
 
             // invalidate corresponding vpage and ppage from the cache hierarchy
-            ooo_cpu[cpu].ITLB.invalidate_entry(NRU_vpage);
-            ooo_cpu[cpu].DTLB.invalidate_entry(NRU_vpage);
-            ooo_cpu[cpu].STLB.invalidate_entry(NRU_vpage);
+            // (a shared page table means the page may be cached by every cpu)
+            for (uint32_t j=0; j<NUM_CPUS; j++) {
+                if (!knob_shared_address_space && (j != cpu))
+                    continue;
+
+                ooo_cpu[j].ITLB.invalidate_entry(NRU_vpage);
+                ooo_cpu[j].DTLB.invalidate_entry(NRU_vpage);
+                ooo_cpu[j].STLB.invalidate_entry(NRU_vpage);
+                for (uint32_t i=0; i<BLOCK_SIZE; i++) {
+                    uint64_t cl_addr = (mapped_ppage << 6) | i;
+                    ooo_cpu[j].L1I.invalidate_entry(cl_addr);
+                    ooo_cpu[j].L1D.invalidate_entry(cl_addr);
+                    ooo_cpu[j].L2C.invalidate_entry(cl_addr);
+                }
+            }
             for (uint32_t i=0; i<BLOCK_SIZE; i++) {
                 uint64_t cl_addr = (mapped_ppage << 6) | i;
-                ooo_cpu[cpu].L1I.invalidate_entry(cl_addr);
-                ooo_cpu[cpu].L1D.invalidate_entry(cl_addr);
-                ooo_cpu[cpu].L2C.invalidate_entry(cl_addr);
                 uncore.LLC.invalidate_entry(cl_addr);
             }
 
@@ -517,6 +604,15 @@ int main(int argc, char** argv)
             {"hide_heartbeat", no_argument, 0, 'h'},
             {"cloudsuite", no_argument, 0, 'c'},
             {"low_bandwidth",  no_argument, 0, 'b'},
+            {"shared_address_space",  no_argument, 0, 'a'},
+            {"llc_partition",  no_argument, 0, 'p'},
+            {"pc_profile",  no_argument, 0, 'f'},
+            {"reuse_profile",  required_argument, 0, 'r'},
+            {"fdp",  no_argument, 0, 'd'},
+            {"btb",  no_argument, 0, 'B'},
+            {"wrong_path",  no_argument, 0, 'W'},
+            {"wrong_path_loads",  no_argument, 0, 'L'},
+            {"uop_cache",  no_argument, 0, 'U'},
             {"traces",  no_argument, 0, 't'},
             {0, 0, 0, 0}      
         };
@@ -548,6 +644,41 @@ int main(int argc, char** argv)
             case 'b':
                 knob_low_bandwidth = 1;
                 break;
+            case 'a':
+                knob_shared_address_space = 1;
+                break;
+            case 'p':
+                knob_llc_partition = 1;
+                break;
+            case 'f':
+                knob_pc_profile = 1;
+                break;
+            case 'r': {
+                char *end;
+                unsigned long rate = strtoul(optarg, &end, 10);
+                if (!isdigit(optarg[0]) || (*end != '\0') || (rate < 1) || (rate > REUSE_MAX_SAMPLE_RATE)) {
+                    cerr << "-reuse_profile takes a sampling rate from 1 (every block) to " << REUSE_MAX_SAMPLE_RATE << ", not " << optarg << endl;
+                    assert(0);
+                }
+                knob_reuse_profile = rate;
+                break;
+            }
+            case 'd':
+                knob_fdp = 1;
+                break;
+            case 'B':
+                knob_btb = 1;
+                break;
+            case 'W':
+                knob_wrong_path = 1;
+                break;
+            case 'L':
+                knob_wrong_path = 1;
+                knob_wrong_path_loads = 1;
+                break;
+            case 'U':
+                knob_uop_cache = 1;
+                break;
             case 't':
                 traces_encountered = 1;
                 break;
@@ -566,6 +697,29 @@ int main(int argc, char** argv)
     cout << "Number of CPUs: " << NUM_CPUS << endl;
     cout << "LLC sets: " << LLC_SET << endl;
     cout << "LLC ways: " << LLC_WAY << endl;
+    if (knob_shared_address_space)
+        cout << "Shared address space with a " << DIR_SET << " sets x " << DIR_WAY << " ways sparse directory" << endl;
+    if (knob_llc_partition)
+        cout << "LLC way partitioning with " << UMON_SET << " sampled sets per utility monitor, repartition every " << UCP_EPOCH << " cycles" << endl;
+    if (knob_pc_profile)
+        cout << "Per-PC load profile with " << PC_PROFILE_SIZE << " PCs per cpu" << endl;
+    if (knob_reuse_profile)
+        cout << "Stack distance profile of the L1I, L1D, L2C and LLC, sampling 1/" << knob_reuse_profile << " of the blocks" << endl;
+    if (knob_fdp)
+        cout << "Feedback directed throttling of the L1D, L2C and LLC prefetcher chains" << endl;
+    if (knob_btb && knob_cloudsuite) {
+        // cloudsuite traces do not say which kind of branch an instruction is, or where it goes
+        cout << "No branch target prediction with cloudsuite traces" << endl;
+        knob_btb = 0;
+    }
+    if (knob_btb)
+        cout << "Branch target prediction with a " << BTB_SET << " sets x " << BTB_WAY << " ways BTB, a " << RAS_SIZE << " entries RAS and ITTAGE" << endl;
+    if (knob_wrong_path) {
+        cout << "Wrong-path fetch of up to " << WRONG_PATH_LINES << " lines" << (knob_wrong_path_loads ? " and their loads" : "") << ", replayed from " << WRONG_PATH_SET << " recorded paths";
+        cout << " (cache pollution only, the branch predictor, BTB, RAS and ITTAGE are not polluted)" << endl;
+    }
+    if (knob_uop_cache)
+        cout << "Uop cache with " << UOP_CACHE_SET << " sets x " << UOP_CACHE_WAY << " ways of " << (1 << LOG2_UOP_CACHE_WINDOW) << "-byte windows, " << UOP_CACHE_WIDTH << " instructions per cycle" << endl;
 
     if (knob_low_bandwidth)
         DRAM_MTPS = DRAM_IO_FREQ/4;
@@ -596,47 +750,7 @@ int main(int argc, char** argv)
         {
             printf("CPU %d runs %s\n", count_traces, argv[i]);
 
-            sprintf(ooo_cpu[count_traces].trace_string, "%s", argv[i]);
-
-            std::string full_name(argv[i]);
-            std::string last_dot = full_name.substr(full_name.find_last_of("."));
-
-            std::string fmtstr;
-            std::string decomp_program;
-            if (full_name.substr(0,4) == "http")
-            {
-                // Check file exists
-                char testfile_command[4096];
-                sprintf(testfile_command, "wget -q --spider %s", argv[i]);
-                FILE *testfile = popen(testfile_command, "r");
-                if (pclose(testfile))
-                {
-                    std::cerr << "TRACE FILE NOT FOUND" << std::endl;
-                    assert(0);
-                }
-                fmtstr = "wget -qO- %2$s | %1$s -dc";
-            }
-            else
-            {
-                std::ifstream testfile(argv[i]);
-                if (!testfile.good())
-                {
-                    std::cerr << "TRACE FILE NOT FOUND" << std::endl;
-                    assert(0);
-                }
-                fmtstr = "%1$s -dc %2$s";
-            }
-
-            if (last_dot[1] == 'g') // gzip format
-                decomp_program = "gzip";
-            else if (last_dot[1] == 'x') // xz
-                decomp_program = "xz";
-            else {
-                std::cout << "ChampSim does not support traces other than gz or xz compression!" << std::endl;
-                assert(0);
-            }
-
-            sprintf(ooo_cpu[count_traces].gunzip_command, fmtstr.c_str(), decomp_program.c_str(), argv[i]);
+            ooo_cpu[count_traces].trace.open(count_traces, argv[i], knob_cloudsuite);
 
             char *pch[100];
             int count_str = 0;
@@ -657,12 +771,6 @@ int main(int argc, char** argv)
                 j++;
             }
 
-            ooo_cpu[count_traces].trace_file = popen(ooo_cpu[count_traces].gunzip_command, "r");
-            if (ooo_cpu[count_traces].trace_file == NULL) {
-                printf("\n*** Trace file not found: %s ***\n\n", argv[i]);
-                assert(0);
-            }
-
             count_traces++;
             if (count_traces > NUM_CPUS) {
                 printf("\n*** Too many traces for the configured number of cores ***\n\n");
@@ -737,6 +845,8 @@ int main(int argc, char** argv)
         ooo_cpu[i].L1D.fill_level = FILL_L1;
         ooo_cpu[i].L1D.lower_level = &ooo_cpu[i].L2C; 
         ooo_cpu[i].L1D.l1d_prefetcher_initialize();
+        uint8_t l1d_chain[] = {PF_NONE, L1D_PREFETCH_CHAIN};
+        ooo_cpu[i].L1D.prefetcher_initialize(l1d_chain, sizeof(l1d_chain));
 
         ooo_cpu[i].L2C.cpu = i;
         ooo_cpu[i].L2C.cache_type = IS_L2C;
@@ -744,7 +854,25 @@ int main(int argc, char** argv)
         ooo_cpu[i].L2C.upper_level_icache[i] = &ooo_cpu[i].L1I;
         ooo_cpu[i].L2C.upper_level_dcache[i] = &ooo_cpu[i].L1D;
         ooo_cpu[i].L2C.lower_level = &uncore.LLC;
+        ooo_cpu[i].L2C.inclusion_policy = L2C_INCLUSION;
+        ooo_cpu[i].L2C.writeback_clean_victims = (LLC_INCLUSION == EXCLUSIVE);
         ooo_cpu[i].L2C.l2c_prefetcher_initialize();
+        uint8_t l2c_chain[] = {PF_NONE, L2C_PREFETCH_CHAIN};
+        ooo_cpu[i].L2C.prefetcher_initialize(l2c_chain, sizeof(l2c_chain));
+
+        // REPLACEMENT (the LLC policy is initialized below)
+        ooo_cpu[i].ITLB.repl_policy = ITLB_REPLACEMENT;
+        ooo_cpu[i].DTLB.repl_policy = DTLB_REPLACEMENT;
+        ooo_cpu[i].STLB.repl_policy = STLB_REPLACEMENT;
+        ooo_cpu[i].L1I.repl_policy = L1I_REPLACEMENT;
+        ooo_cpu[i].L1D.repl_policy = L1D_REPLACEMENT;
+        ooo_cpu[i].L2C.repl_policy = L2C_REPLACEMENT;
+        ooo_cpu[i].ITLB.initialize_replacement();
+        ooo_cpu[i].DTLB.initialize_replacement();
+        ooo_cpu[i].STLB.initialize_replacement();
+        ooo_cpu[i].L1I.initialize_replacement();
+        ooo_cpu[i].L1D.initialize_replacement();
+        ooo_cpu[i].L2C.initialize_replacement();
 
         // SHARED CACHE
         uncore.LLC.cache_type = IS_LLC;
@@ -753,6 +881,45 @@ int main(int argc, char** argv)
         uncore.LLC.upper_level_icache[i] = &ooo_cpu[i].L2C;
         uncore.LLC.upper_level_dcache[i] = &ooo_cpu[i].L2C;
         uncore.LLC.lower_level = &uncore.DRAM;
+        uncore.LLC.inclusion_policy = LLC_INCLUSION;
+
+        // COHERENCE
+        if (knob_shared_address_space) {
+            uncore.directory.L1D[i] = &ooo_cpu[i].L1D;
+            uncore.directory.L2C[i] = &ooo_cpu[i].L2C;
+            uncore.directory.LLC = &uncore.LLC;
+            ooo_cpu[i].L1D.directory = &uncore.directory;
+            ooo_cpu[i].L2C.directory = &uncore.directory;
+            uncore.LLC.directory = &uncore.directory;
+
+            // requests from different cpus to one block are no longer merged at the LLC
+            uncore.LLC.RQ.match_cpu = 1;
+            uncore.LLC.PQ.match_cpu = 1;
+        }
+
+        // LLC WAY PARTITIONING
+        if (knob_llc_partition)
+            uncore.LLC.partition = &uncore.partition;
+
+        // PER-PC LOAD PROFILE
+        if (knob_pc_profile) {
+            ooo_cpu[i].L1D.pc_profile = &uncore.pc_profile;
+            ooo_cpu[i].L2C.pc_profile = &uncore.pc_profile;
+            uncore.LLC.pc_profile = &uncore.pc_profile;
+        }
+
+        // STACK DISTANCE PROFILE
+        if (knob_reuse_profile) {
+            ooo_cpu[i].L1I.reuse_profile.init(knob_reuse_profile);
+            ooo_cpu[i].L1D.reuse_profile.init(knob_reuse_profile);
+            ooo_cpu[i].L2C.reuse_profile.init(knob_reuse_profile);
+        }
+
+        // PREFETCH THROTTLING (an interval is half as many fills as the cache has blocks)
+        if (knob_fdp) {
+            ooo_cpu[i].L1D.fdp.init(ooo_cpu[i].L1D.NUM_LINE/2);
+            ooo_cpu[i].L2C.fdp.init(ooo_cpu[i].L2C.NUM_LINE/2);
+        }
 
         // OFF-CHIP DRAM
         uncore.DRAM.fill_level = FILL_DRAM;
@@ -780,6 +947,12 @@ int main(int argc, char** argv)
 
     uncore.LLC.llc_initialize_replacement();
     uncore.LLC.llc_prefetcher_initialize();
+    uint8_t llc_chain[] = {PF_NONE, LLC_PREFETCH_CHAIN};
+    uncore.LLC.prefetcher_initialize(llc_chain, sizeof(llc_chain));
+    if (knob_reuse_profile)
+        uncore.LLC.reuse_profile.init(knob_reuse_profile);
+    if (knob_fdp)
+        uncore.LLC.fdp.init(uncore.LLC.NUM_LINE/2);
 
     // simulation entry point
     start_time = time(NULL);
@@ -833,6 +1006,9 @@ int main(int argc, char** argv)
 	      // fetch
 	      ooo_cpu[i].fetch_instruction();
 	      
+	      // predict ahead into the FTQ
+	      ooo_cpu[i].predict_fetch_block();
+
 	      // read from trace
 	      if ((ooo_cpu[i].IFETCH_BUFFER.occupancy < ooo_cpu[i].IFETCH_BUFFER.SIZE) && (ooo_cpu[i].fetch_stall == 0))
 		{
@@ -907,6 +1083,8 @@ int main(int argc, char** argv)
         // TODO: should it be backward?
         uncore.DRAM.operate();
         uncore.LLC.operate();
+        if (knob_llc_partition)
+            uncore.partition.operate(current_core_cycle[0]);
     }
 
     uint64_t elapsed_second = (uint64_t)(time(NULL) - start_time),
@@ -928,10 +1106,13 @@ int main(int argc, char** argv)
 	    ooo_cpu[i].l1i_prefetcher_final_stats();
             ooo_cpu[i].L1D.l1d_prefetcher_final_stats();
 	    ooo_cpu[i].L2C.l2c_prefetcher_final_stats();
+            ooo_cpu[i].L1D.prefetcher_final_stats();
+            ooo_cpu[i].L2C.prefetcher_final_stats();
 #endif
             print_sim_stats(i, &uncore.LLC);
         }
         uncore.LLC.llc_prefetcher_final_stats();
+        uncore.LLC.prefetcher_final_stats();
     }
 
     cout << endl << "Region of Interest Statistics" << endl;
@@ -944,6 +1125,7 @@ int main(int argc, char** argv)
         print_roi_stats(i, &ooo_cpu[i].L2C);
 #endif
         print_roi_stats(i, &uncore.LLC);
+        ooo_cpu[i].load_latency.print("CPU " + to_string(i) + " LOAD LATENCY");
         cout << "Major fault: " << major_fault[i] << " Minor fault: " << minor_fault[i] << endl;
     }
 
@@ -951,13 +1133,31 @@ int main(int argc, char** argv)
         ooo_cpu[i].l1i_prefetcher_final_stats();
         ooo_cpu[i].L1D.l1d_prefetcher_final_stats();
         ooo_cpu[i].L2C.l2c_prefetcher_final_stats();
+        ooo_cpu[i].L1D.prefetcher_final_stats();
+        ooo_cpu[i].L2C.prefetcher_final_stats();
     }
 
     uncore.LLC.llc_prefetcher_final_stats();
+    uncore.LLC.prefetcher_final_stats();
 
 #ifndef CRC2_COMPILE
     uncore.LLC.llc_replacement_final_stats();
     print_dram_stats();
+    if (knob_shared_address_space)
+        uncore.directory.print_stats();
+    if (knob_llc_partition)
+        uncore.partition.print_stats();
+    if (knob_pc_profile)
+        uncore.pc_profile.print_stats();
+    if (knob_reuse_profile) {
+        cout << endl << "Stack Distance Profile (miss ratio of a fully associative LRU cache of every size)" << endl;
+        for (uint32_t i=0; i<NUM_CPUS; i++) {
+            ooo_cpu[i].L1I.reuse_profile.print_stats(ooo_cpu[i].L1I.NAME, ooo_cpu[i].L1I.NUM_LINE);
+            ooo_cpu[i].L1D.reuse_profile.print_stats(ooo_cpu[i].L1D.NAME, ooo_cpu[i].L1D.NUM_LINE);
+            ooo_cpu[i].L2C.reuse_profile.print_stats(ooo_cpu[i].L2C.NAME, ooo_cpu[i].L2C.NUM_LINE);
+        }
+        uncore.LLC.reuse_profile.print_stats(uncore.LLC.NAME, uncore.LLC.NUM_LINE);
+    }
     print_branch_stats();
 #endif
 
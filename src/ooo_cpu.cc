@@ -11,388 +11,186 @@ void O3_CPU::initialize_core()
 
 }
 
-void O3_CPU::read_from_trace()
+void O3_CPU::predict_fetch_block()
 {
-    // actual processors do not work like this but for easier implementation,
-    // we read instruction traces and virtually add them in the ROB
-    // note that these traces are not yet translated and fetched 
-
-    uint8_t continue_reading = 1;
-    uint32_t num_reads = 0;
-    instrs_to_read_this_cycle = FETCH_WIDTH;
+    // the branch predictor runs ahead of fetch, one fetch block per cycle, and stops after a
+    // misprediction until fetch resumes, since the correct path is unknown until the branch executes
+    if (bpu_stall || (FTQ.size() >= FTQ_SIZE))
+        return;
 
-    // first, read PIN trace
-    while (continue_reading) {
+    FTQ_ENTRY block;
+    while (block.num_instrs < FTQ_BLOCK_SIZE) {
+        ooo_model_instr arch_instr;
+        if (decode_trace_instr(&arch_instr) == 0)
+            continue;
 
-        size_t instr_size = knob_cloudsuite ? sizeof(cloudsuite_instr) : sizeof(input_instr);
+        if (knob_wrong_path)
+            wrong_path.record(&arch_instr);
 
-        if (knob_cloudsuite) {
-            if (!fread(&current_cloudsuite_instr, instr_size, 1, trace_file)) {
-                // reached end of file for this trace
-                cout << "*** Reached end of trace for Core: " << cpu << " Repeating trace: " << trace_string << endl; 
+        if (block.num_instrs == 0)
+            block.start_ip = arch_instr.ip;
+        block.end_ip = arch_instr.ip;
+        block.num_instrs++;
 
-                // close the trace file and re-open it
-                pclose(trace_file);
-                trace_file = popen(gunzip_command, "r");
-                if (trace_file == NULL) {
-                    cerr << endl << "*** CANNOT REOPEN TRACE FILE: " << trace_string << " ***" << endl;
-                    assert(0);
-                }
-            } else { // successfully read the trace
+        if (arch_instr.is_branch) {
+            // handle branch prediction & branch predictor update
+            arch_instr.branch_prediction = predict_branch(arch_instr.ip);
+            uint64_t predicted_branch_target = arch_instr.branch_target;
 
-                // copy the instruction into the performance model's instruction format
-                ooo_model_instr arch_instr;
-                int num_reg_ops = 0, num_mem_ops = 0;
+            if (knob_btb) {
+                uint8_t btb_hit;
+                predicted_branch_target = btb.predict(arch_instr.ip, arch_instr.branch_type, btb_hit);
 
-                arch_instr.instr_id = instr_unique_id;
-                arch_instr.ip = current_cloudsuite_instr.ip;
-                arch_instr.is_branch = current_cloudsuite_instr.is_branch;
-                arch_instr.branch_taken = current_cloudsuite_instr.branch_taken;
+                // the BTB or else decode knows which branches are unconditional, and decode
+                // computes the direct targets the BTB misses
+                if ((arch_instr.branch_type != BRANCH_CONDITIONAL) && (arch_instr.branch_type != BRANCH_OTHER))
+                    arch_instr.branch_prediction = 1;
+                if (!btb_hit && (arch_instr.branch_type != BRANCH_RETURN) && (arch_instr.branch_type != BRANCH_INDIRECT) && (arch_instr.branch_type != BRANCH_INDIRECT_CALL))
+                    predicted_branch_target = arch_instr.branch_target;
 
-                arch_instr.asid[0] = current_cloudsuite_instr.asid[0];
-                arch_instr.asid[1] = current_cloudsuite_instr.asid[1];
+                if ((arch_instr.branch_taken != arch_instr.branch_prediction) || (arch_instr.branch_taken && (predicted_branch_target != arch_instr.branch_target)))
+                    arch_instr.branch_redirect = REDIRECT_EXECUTE;
+                else if (arch_instr.branch_taken && !btb_hit)
+                    arch_instr.branch_redirect = REDIRECT_DECODE;
 
-                for (uint32_t i=0; i<MAX_INSTR_DESTINATIONS; i++) {
-                    arch_instr.destination_registers[i] = current_cloudsuite_instr.destination_registers[i];
-                    arch_instr.destination_memory[i] = current_cloudsuite_instr.destination_memory[i];
-                    arch_instr.destination_virtual_address[i] = current_cloudsuite_instr.destination_memory[i];
+                btb.update(arch_instr.ip, arch_instr.branch_type, arch_instr.branch_taken, arch_instr.branch_target);
+            }
+            else if (arch_instr.branch_taken != arch_instr.branch_prediction)
+                arch_instr.branch_redirect = REDIRECT_EXECUTE;
 
-                    if (arch_instr.destination_registers[i])
-                        num_reg_ops++;
-                    if (arch_instr.destination_memory[i]) {
-                        num_mem_ops++;
+            if (arch_instr.branch_prediction == 0)
+                predicted_branch_target = 0;
 
-                        // update STA, this structure is required to execute store instructions properly without deadlock
-                        if (num_mem_ops > 0) {
-#ifdef SANITY_CHECK
-                            if (STA[STA_tail] < UINT64_MAX) {
-                                if (STA_head != STA_tail)
-                                    assert(0);
-                            }
-#endif
-                            STA[STA_tail] = instr_unique_id;
-                            STA_tail++;
+            // call code prefetcher every time the branch predictor is used
+            l1i_prefetcher_branch_operate(arch_instr.ip, arch_instr.branch_type, predicted_branch_target);
 
-                            if (STA_tail == STA_SIZE)
-                                STA_tail = 0;
-                        }
-                    }
-                }
+            // fetch will go the predicted way, or straight on past a taken branch only decode finds
+            if (knob_wrong_path && warmup_complete[cpu] && (arch_instr.branch_redirect != REDIRECT_NONE))
+                wrong_path.arm(arch_instr.ip, (arch_instr.branch_redirect == REDIRECT_EXECUTE) && arch_instr.branch_prediction, predicted_branch_target);
 
-                for (int i=0; i<NUM_INSTR_SOURCES; i++) {
-                    arch_instr.source_registers[i] = current_cloudsuite_instr.source_registers[i];
-                    arch_instr.source_memory[i] = current_cloudsuite_instr.source_memory[i];
-                    arch_instr.source_virtual_address[i] = current_cloudsuite_instr.source_memory[i];
+            last_branch_result(arch_instr.ip, arch_instr.branch_taken);
+        }
 
-                    if (arch_instr.source_registers[i])
-                        num_reg_ops++;
-                    if (arch_instr.source_memory[i])
-                        num_mem_ops++;
-                }
+        FTQ_INSTR.push_back(arch_instr);
 
-                arch_instr.num_reg_ops = num_reg_ops;
-                arch_instr.num_mem_ops = num_mem_ops;
-                if (num_mem_ops > 0) 
-                    arch_instr.is_memory = 1;
-
-                // add this instruction to the IFETCH_BUFFER
-                if (IFETCH_BUFFER.occupancy < IFETCH_BUFFER.SIZE) {
-		  uint32_t ifetch_buffer_index = add_to_ifetch_buffer(&arch_instr);
-		  num_reads++;
-
-		  // handle branch prediction
-		  if (IFETCH_BUFFER.entry[ifetch_buffer_index].is_branch) {
-		    DP( if (warmup_complete[cpu]) {
-                        cout << "[BRANCH] instr_id: " << instr_unique_id << " ip: " << hex << arch_instr.ip << dec << " taken: " << +arch_instr.branch_taken << endl; });
-		    
-		    num_branch++;
-		    
-		    // handle branch prediction & branch predictor update
-		    uint8_t branch_prediction = predict_branch(IFETCH_BUFFER.entry[ifetch_buffer_index].ip);
-		    
-		    if(IFETCH_BUFFER.entry[ifetch_buffer_index].branch_taken != branch_prediction)
-		      {
-			branch_mispredictions++;
-			total_rob_occupancy_at_branch_mispredict += ROB.occupancy;
-			if(warmup_complete[cpu])
-			  {
-			    fetch_stall = 1;
-			    instrs_to_read_this_cycle = 0;
-			    IFETCH_BUFFER.entry[ifetch_buffer_index].branch_mispredicted = 1;
-			  }
-		      }
-		    else
-		      {
-			// correct prediction
-			if(branch_prediction == 1)
-			  {
-			    // if correctly predicted taken, then we can't fetch anymore instructions this cycle
-			    instrs_to_read_this_cycle = 0;
-			  }
-		      }
-		    
-		    last_branch_result(IFETCH_BUFFER.entry[ifetch_buffer_index].ip, IFETCH_BUFFER.entry[ifetch_buffer_index].branch_taken);
-		  }
-		  
-		  if ((num_reads >= instrs_to_read_this_cycle) || (IFETCH_BUFFER.occupancy == IFETCH_BUFFER.SIZE))
-		    continue_reading = 0;
-                }
-                instr_unique_id++;
-            }
+        // redirects cost nothing during warmup, so the predictor does not have to wait either
+        if (arch_instr.is_branch) {
+            if ((arch_instr.branch_redirect != REDIRECT_NONE) && warmup_complete[cpu])
+                bpu_stall = 1;
+            if (bpu_stall || ((arch_instr.branch_redirect != REDIRECT_EXECUTE) && arch_instr.branch_prediction))
+                break;
         }
-	else
-	  {
-	    input_instr trace_read_instr;
-            if (!fread(&trace_read_instr, instr_size, 1, trace_file))
-	      {
-                // reached end of file for this trace
-                cout << "*** Reached end of trace for Core: " << cpu << " Repeating trace: " << trace_string << endl; 
-		
-                // close the trace file and re-open it
-                pclose(trace_file);
-                trace_file = popen(gunzip_command, "r");
-                if (trace_file == NULL) {
-		  cerr << endl << "*** CANNOT REOPEN TRACE FILE: " << trace_string << " ***" << endl;
-                    assert(0);
-                }
-            }
-	    else
-	      { // successfully read the trace
+    }
 
-		if(instr_unique_id == 0)
-		  {
-		    current_instr = next_instr = trace_read_instr;
-		  }
-		else
-		  {
-		    current_instr = next_instr;
-		    next_instr = trace_read_instr;
-		  }
+    FTQ.push_back(block);
+}
 
-                // copy the instruction into the performance model's instruction format
-                ooo_model_instr arch_instr;
-                int num_reg_ops = 0, num_mem_ops = 0;
+uint8_t O3_CPU::decode_trace_instr(ooo_model_instr *decoded_instr)
+{
+    // actual processors do not work like this but for easier implementation,
+    // we read instruction traces and virtually add them in the ROB
+    // note that these traces are not yet translated and fetched 
 
-                arch_instr.instr_id = instr_unique_id;
-                arch_instr.ip = current_instr.ip;
-                arch_instr.is_branch = current_instr.is_branch;
-                arch_instr.branch_taken = current_instr.branch_taken;
+    if (trace.read(decoded_instr) == 0)
+        return 0;
 
-                arch_instr.asid[0] = cpu;
-                arch_instr.asid[1] = cpu;
+    decoded_instr->instr_id = instr_unique_id;
 
-		bool reads_sp = false;
-		bool writes_sp = false;
-		bool reads_flags = false;
-		bool reads_ip = false;
-		bool writes_ip = false;
-		bool reads_other = false;
+    // update STA, this structure is required to execute store instructions properly without deadlock
+    for (uint32_t i=0; i<MAX_INSTR_DESTINATIONS; i++) {
+        if (decoded_instr->destination_memory[i] == 0)
+            continue;
 
-                for (uint32_t i=0; i<MAX_INSTR_DESTINATIONS; i++) {
-                    arch_instr.destination_registers[i] = current_instr.destination_registers[i];
-                    arch_instr.destination_memory[i] = current_instr.destination_memory[i];
-                    arch_instr.destination_virtual_address[i] = current_instr.destination_memory[i];
-
-		    switch(arch_instr.destination_registers[i])
-		      {
-		      case 0:
-			break;
-		      case REG_STACK_POINTER:
-			writes_sp = true;
-			break;
-		      case REG_INSTRUCTION_POINTER:
-			writes_ip = true;
-			break;
-		      default:
-			break;
-		      }
-
-		    /*
-		    if((arch_instr.is_branch) && (arch_instr.destination_registers[i] > 24) && (arch_instr.destination_registers[i] < 28))
-		      {
-			arch_instr.destination_registers[i] = 0;
-		      }
-		    */
-		    
-                    if (arch_instr.destination_registers[i])
-                        num_reg_ops++;
-                    if (arch_instr.destination_memory[i]) {
-                        num_mem_ops++;
-
-                        // update STA, this structure is required to execute store instructions properly without deadlock
-                        if (num_mem_ops > 0) {			  
 #ifdef SANITY_CHECK
-                            if (STA[STA_tail] < UINT64_MAX) {
-                                if (STA_head != STA_tail)
-                                    assert(0);
-                            }
+        if (STA[STA_tail] < UINT64_MAX) {
+            if (STA_head != STA_tail)
+                assert(0);
+        }
 #endif
-                            STA[STA_tail] = instr_unique_id;
-                            STA_tail++;
+        STA[STA_tail] = instr_unique_id;
+        STA_tail++;
 
-                            if (STA_tail == STA_SIZE)
-                                STA_tail = 0;
-                        }
-                    }
-                }
+        if (STA_tail == STA_SIZE)
+            STA_tail = 0;
+    }
 
-                for (int i=0; i<NUM_INSTR_SOURCES; i++) {
-                    arch_instr.source_registers[i] = current_instr.source_registers[i];
-                    arch_instr.source_memory[i] = current_instr.source_memory[i];
-                    arch_instr.source_virtual_address[i] = current_instr.source_memory[i];
-
-		    switch(arch_instr.source_registers[i])
-                      {
-                      case 0:
-                        break;
-                      case REG_STACK_POINTER:
-                        reads_sp = true;
-                        break;
-                      case REG_FLAGS:
-                        reads_flags = true;
-                        break;
-                      case REG_INSTRUCTION_POINTER:
-                        reads_ip = true;
-                        break;
-                      default:
-                        reads_other = true;
-                        break;
-                      }
-		    
-		    /*
-		    if((!arch_instr.is_branch) && (arch_instr.source_registers[i] > 25) && (arch_instr.source_registers[i] < 28))
-		      {
-			arch_instr.source_registers[i] = 0;
-		      }
-		    */
-		    
-                    if (arch_instr.source_registers[i])
-                        num_reg_ops++;
-                    if (arch_instr.source_memory[i])
-                        num_mem_ops++;
-                }
+    instr_unique_id++;
+    return 1;
+}
 
-                arch_instr.num_reg_ops = num_reg_ops;
-                arch_instr.num_mem_ops = num_mem_ops;
-                if (num_mem_ops > 0) 
-                    arch_instr.is_memory = 1;
 
-		// determine what kind of branch this is, if any
-		if(!reads_sp && !reads_flags && writes_ip && !reads_other)
-		  {
-		    // direct jump
-		    arch_instr.is_branch = 1;
-                    arch_instr.branch_taken = 1;
-                    arch_instr.branch_type = BRANCH_DIRECT_JUMP;
-		  }
-		else if(!reads_sp && !reads_flags && writes_ip && reads_other)
-		  {
-		    // indirect branch
-		    arch_instr.is_branch = 1;
-                    arch_instr.branch_taken = 1;
-                    arch_instr.branch_type = BRANCH_INDIRECT;
-		  }
-		else if(!reads_sp && reads_ip && !writes_sp && writes_ip && reads_flags && !reads_other)
-		  {
-		    // conditional branch
-		    arch_instr.is_branch = 1;
-		    arch_instr.branch_taken = arch_instr.branch_taken; // don't change this
-		    arch_instr.branch_type = BRANCH_CONDITIONAL;
-		  }
-		else if(reads_sp && reads_ip && writes_sp && writes_ip && !reads_flags && !reads_other)
-		  {
-		    // direct call
-		    arch_instr.is_branch = 1;
-		    arch_instr.branch_taken = 1;
-		    arch_instr.branch_type = BRANCH_DIRECT_CALL;
-		  }
-		else if(reads_sp && reads_ip && writes_sp && writes_ip && !reads_flags && reads_other)
-		  {
-		    // indirect call
-		    arch_instr.is_branch = 1;
-		    arch_instr.branch_taken = 1;
-		    arch_instr.branch_type = BRANCH_INDIRECT_CALL;
-		  }
-		else if(reads_sp && !reads_ip && writes_sp && writes_ip)
-		  {
-		    // return
-		    arch_instr.is_branch = 1;
-		    arch_instr.branch_taken = 1;
-		    arch_instr.branch_type = BRANCH_RETURN;
-		  }
-		else if(writes_ip)
-		  {
-		    // some other branch type that doesn't fit the above categories
-		    arch_instr.is_branch = 1;
-                    arch_instr.branch_taken = arch_instr.branch_taken; // don't change this
-                    arch_instr.branch_type = BRANCH_OTHER;
-		  }
+void O3_CPU::read_from_trace()
+{
+    // fetch the instructions the branch predictor put in the FTQ
+    uint8_t continue_reading = 1;
+    uint32_t num_reads = 0;
+    instrs_to_read_this_cycle = knob_uop_cache ? UOP_CACHE_WIDTH : FETCH_WIDTH;
 
-		total_branch_types[arch_instr.branch_type]++;
-		
-		if((arch_instr.is_branch == 1) && (arch_instr.branch_taken == 1))
-		  {
-		    arch_instr.branch_target = next_instr.ip;
-		  }
+    while (continue_reading && FTQ_INSTR.size()) {
+        // past FETCH_WIDTH, only the uop cache delivers more instructions this cycle
+        if (knob_uop_cache && (num_reads >= FETCH_WIDTH) && !uop_cache.probe(FTQ_INSTR.front().ip))
+            break;
 
-                // add this instruction to the IFETCH_BUFFER
-                if (IFETCH_BUFFER.occupancy < IFETCH_BUFFER.SIZE) {
-		  uint32_t ifetch_buffer_index = add_to_ifetch_buffer(&arch_instr);
-		  num_reads++;
-
-                    // handle branch prediction
-                    if (IFETCH_BUFFER.entry[ifetch_buffer_index].is_branch) {
-
-                        DP( if (warmup_complete[cpu]) {
-                        cout << "[BRANCH] instr_id: " << instr_unique_id << " ip: " << hex << arch_instr.ip << dec << " taken: " << +arch_instr.branch_taken << endl; });
-
-                        num_branch++;
-
-			// handle branch prediction & branch predictor update
-			uint8_t branch_prediction = predict_branch(IFETCH_BUFFER.entry[ifetch_buffer_index].ip);
-			uint64_t predicted_branch_target = IFETCH_BUFFER.entry[ifetch_buffer_index].branch_target;
-			if(branch_prediction == 0)
-			  {
-			    predicted_branch_target = 0;
-			  }
-			// call code prefetcher every time the branch predictor is used
-			l1i_prefetcher_branch_operate(IFETCH_BUFFER.entry[ifetch_buffer_index].ip,
-						      IFETCH_BUFFER.entry[ifetch_buffer_index].branch_type,
-						      predicted_branch_target);
-			
-			if(IFETCH_BUFFER.entry[ifetch_buffer_index].branch_taken != branch_prediction)
-			  {
-			    branch_mispredictions++;
-			    total_rob_occupancy_at_branch_mispredict += ROB.occupancy;
-			    if(warmup_complete[cpu])
-			      {
-				fetch_stall = 1;
-				instrs_to_read_this_cycle = 0;
-				IFETCH_BUFFER.entry[ifetch_buffer_index].branch_mispredicted = 1;
-			      }
-			  }
-			else
-			  {
-			    // correct prediction
-			    if(branch_prediction == 1)
-			      {
-				// if correctly predicted taken, then we can't fetch anymore instructions this cycle
-				instrs_to_read_this_cycle = 0;
-			      }
-			  }
-			
-			last_branch_result(IFETCH_BUFFER.entry[ifetch_buffer_index].ip, IFETCH_BUFFER.entry[ifetch_buffer_index].branch_taken);
-                    }
+        ooo_model_instr arch_instr = FTQ_INSTR.front();
+        FTQ_INSTR.pop_front();
+        if (++FTQ.front().fetched == FTQ.front().num_instrs)
+            FTQ.pop_front();
+
+        total_branch_types[arch_instr.branch_type]++;
+
+        // add this instruction to the IFETCH_BUFFER
+        uint32_t ifetch_buffer_index = add_to_ifetch_buffer(&arch_instr);
+        num_reads++;
 
-                    if ((num_reads >= instrs_to_read_this_cycle) || (IFETCH_BUFFER.occupancy == IFETCH_BUFFER.SIZE))
-                        continue_reading = 0;
+        // the uop cache has it decoded already, so it needs no fetch from the L1I
+        if (knob_uop_cache && uop_cache.lookup(arch_instr.ip)) {
+            IFETCH_BUFFER.entry[ifetch_buffer_index].uop_cache_hit = 1;
+            IFETCH_BUFFER.entry[ifetch_buffer_index].fetched = COMPLETED;
+        }
+
+        // handle branch prediction
+        if (IFETCH_BUFFER.entry[ifetch_buffer_index].is_branch) {
+
+            DP( if (warmup_complete[cpu]) {
+            cout << "[BRANCH] instr_id: " << arch_instr.instr_id << " ip: " << hex << arch_instr.ip << dec << " taken: " << +arch_instr.branch_taken << endl; });
+
+            num_branch++;
+
+            if (IFETCH_BUFFER.entry[ifetch_buffer_index].branch_redirect == REDIRECT_DECODE) {
+                // fetch goes on past the branch until decode finds it
+                btb.decode_redirects++;
+                instrs_to_read_this_cycle = 0;
+                if (warmup_complete[cpu]) {
+                    fetch_stall = 1;
+                    if (knob_wrong_path)
+                        wrong_path.start();
+                }
+                else
+                    IFETCH_BUFFER.entry[ifetch_buffer_index].branch_redirect = REDIRECT_NONE;
+            }
+            else if (IFETCH_BUFFER.entry[ifetch_buffer_index].branch_redirect == REDIRECT_EXECUTE) {
+                branch_mispredictions++;
+                total_rob_occupancy_at_branch_mispredict += ROB.occupancy;
+                if (warmup_complete[cpu]) {
+                    fetch_stall = 1;
+                    instrs_to_read_this_cycle = 0;
+                    IFETCH_BUFFER.entry[ifetch_buffer_index].branch_mispredicted = 1;
+                    if (knob_wrong_path)
+                        wrong_path.start();
+                }
+            }
+            else {
+                // correct prediction
+                if (IFETCH_BUFFER.entry[ifetch_buffer_index].branch_prediction == 1) {
+                    // if correctly predicted taken, then we can't fetch anymore instructions this cycle
+                    instrs_to_read_this_cycle = 0;
                 }
-                instr_unique_id++;
             }
         }
-    }
 
-    //instrs_to_fetch_this_cycle = num_reads;
+        if ((num_reads >= instrs_to_read_this_cycle) || (IFETCH_BUFFER.occupancy == IFETCH_BUFFER.SIZE))
+            continue_reading = 0;
+    }
 }
 
 uint32_t O3_CPU::add_to_rob(ooo_model_instr *arch_instr)
@@ -551,14 +349,19 @@ uint32_t O3_CPU::check_rob(uint64_t instr_id)
 
 void O3_CPU::fetch_instruction()
 {
-  // TODO: can we model wrong path execusion?
-  // probalby not
-  
   // if we had a branch mispredict, turn fetching back on after the branch mispredict penalty
   if((fetch_stall == 1) && (current_core_cycle[cpu] >= fetch_resume_cycle) && (fetch_resume_cycle != 0))
     {
       fetch_stall = 0;
       fetch_resume_cycle = 0;
+      bpu_stall = 0;
+      wrong_path.stop();
+    }
+
+  // until then, fetch goes down the wrong path
+  if (knob_wrong_path && fetch_stall)
+    {
+      fetch_wrong_path();
     }
 
   if(IFETCH_BUFFER.occupancy == 0)
@@ -657,7 +460,7 @@ void O3_CPU::fetch_instruction()
 	      // mark all instructions from this cache line as having been fetched
 	      for(uint32_t j=0; j<IFETCH_BUFFER.SIZE; j++)
 		{
-		  if(((IFETCH_BUFFER.entry[j].ip)>>6) == ((IFETCH_BUFFER.entry[index].ip)>>6))
+		  if((((IFETCH_BUFFER.entry[j].ip)>>6) == ((IFETCH_BUFFER.entry[index].ip)>>6)) && (IFETCH_BUFFER.entry[j].uop_cache_hit == 0))
 		    {
 		      IFETCH_BUFFER.entry[j].translated = COMPLETED;
 		      IFETCH_BUFFER.entry[j].fetched = INFLIGHT;
@@ -678,9 +481,11 @@ void O3_CPU::fetch_instruction()
 	}
     }
   
-  // send to DECODE stage
+  // send to DECODE stage: DECODE_WIDTH instructions a cycle through the legacy decoders, or
+  // UOP_CACHE_WIDTH from the uop cache, which skip the decode latency
   bool decode_full = false;
-  for(uint32_t i=0; i<DECODE_WIDTH; i++)
+  uint32_t decode_width = knob_uop_cache ? max(DECODE_WIDTH, UOP_CACHE_WIDTH) : DECODE_WIDTH;
+  for(uint32_t i=0; i<decode_width; i++)
     {
       if(decode_full)
 	{
@@ -694,10 +499,29 @@ void O3_CPU::fetch_instruction()
       
       if((IFETCH_BUFFER.entry[IFETCH_BUFFER.head].translated == COMPLETED) && (IFETCH_BUFFER.entry[IFETCH_BUFFER.head].fetched == COMPLETED))
 	{
+	  if(knob_uop_cache)
+	    {
+	      uint8_t hit = IFETCH_BUFFER.entry[IFETCH_BUFFER.head].uop_cache_hit;
+	      if(!uop_cache.deliver(hit, current_core_cycle[cpu]) || (i >= (hit ? UOP_CACHE_WIDTH : DECODE_WIDTH)))
+		{
+		  break;
+		}
+	    }
+
 	  if(DECODE_BUFFER.occupancy < DECODE_BUFFER.SIZE)
 	    {
 	      uint32_t decode_index = add_to_decode_buffer(&IFETCH_BUFFER.entry[IFETCH_BUFFER.head]);
 	      DECODE_BUFFER.entry[decode_index].event_cycle = 0;
+
+	      if(IFETCH_BUFFER.entry[IFETCH_BUFFER.head].uop_cache_hit)
+		{
+		  // already decoded
+		  DECODE_BUFFER.entry[decode_index].event_cycle = current_core_cycle[cpu];
+		}
+	      else if(knob_uop_cache)
+		{
+		  uop_cache.fill(IFETCH_BUFFER.entry[IFETCH_BUFFER.head].ip);
+		}
 	      
 	      ooo_model_instr empty_entry;
 	      IFETCH_BUFFER.entry[IFETCH_BUFFER.head] = empty_entry;
@@ -723,6 +547,92 @@ void O3_CPU::fetch_instruction()
     }
 }
 
+void O3_CPU::fetch_wrong_path()
+{
+    // the branch was resolved, fetch only waits to restart on the correct path
+    if (fetch_resume_cycle != 0) {
+        wrong_path.stop();
+        return;
+    }
+
+    uint64_t line = wrong_path.line();
+    if (line == 0)
+        return;
+
+    // nothing waits for the wrong-path returns, so they must not take the room the correct path needs
+    if ((ITLB.PROCESSED.occupancy >= (ITLB.PROCESSED.SIZE / 2)) || (L1I.PROCESSED.occupancy >= (L1I.PROCESSED.SIZE / 2)) || (L1I.RQ.occupancy == L1I.RQ.SIZE))
+        return;
+
+    // a line per cycle: the ITLB sees every new page, and the L1I every line
+    if ((line >> LOG2_PAGE_SIZE) != wrong_path.last_page) {
+        PACKET tlb_packet;
+        tlb_packet.instruction = 1;
+        tlb_packet.is_data = 0;
+        tlb_packet.tlb_access = 1;
+        tlb_packet.fill_level = FILL_L1;
+        tlb_packet.fill_l1i = 1;
+        tlb_packet.cpu = cpu;
+        tlb_packet.address = line >> LOG2_PAGE_SIZE;
+        tlb_packet.full_addr = line;
+        tlb_packet.rob_index = 0;
+        tlb_packet.ip = line;
+        tlb_packet.type = LOAD;
+        tlb_packet.asid[0] = 0;
+        tlb_packet.asid[1] = 0;
+        tlb_packet.event_cycle = current_core_cycle[cpu];
+        tlb_packet.wrong_path = 1;
+
+        if (ITLB.add_rq(&tlb_packet) == -2)
+            return;
+        wrong_path.last_page = line >> LOG2_PAGE_SIZE;
+    }
+
+    // like the instructions of the correct path, the line does not wait for its translation
+    uint64_t line_pa = (va_to_pa(cpu, 0, line, line >> LOG2_PAGE_SIZE, 1) & (~((1 << LOG2_PAGE_SIZE) - 1))) | (line & ((1 << LOG2_PAGE_SIZE) - 1));
+
+    PACKET fetch_packet;
+    fetch_packet.instruction = 1;
+    fetch_packet.is_data = 0;
+    fetch_packet.fill_level = FILL_L1;
+    fetch_packet.fill_l1i = 1;
+    fetch_packet.cpu = cpu;
+    fetch_packet.address = line_pa >> LOG2_BLOCK_SIZE;
+    fetch_packet.instruction_pa = line_pa;
+    fetch_packet.full_addr = line_pa;
+    fetch_packet.rob_index = 0;
+    fetch_packet.ip = line;
+    fetch_packet.type = LOAD;
+    fetch_packet.asid[0] = 0;
+    fetch_packet.asid[1] = 0;
+    fetch_packet.event_cycle = current_core_cycle[cpu];
+    fetch_packet.wrong_path = 1;
+
+    if (L1I.add_rq(&fetch_packet) == -2)
+        return;
+
+    // the load the line had on the correct path is translated by the DTLB, and then goes to the L1D
+    uint64_t load_ip, load = wrong_path.load(load_ip);
+    if (knob_wrong_path_loads && load && (DTLB.RQ.occupancy < DTLB.RQ.SIZE) && (DTLB.PROCESSED.occupancy < (DTLB.PROCESSED.SIZE / 2))) {
+        PACKET tlb_packet;
+        tlb_packet.fill_level = FILL_L1;
+        tlb_packet.fill_l1d = 1;
+        tlb_packet.cpu = cpu;
+        tlb_packet.address = load >> LOG2_PAGE_SIZE;
+        tlb_packet.full_addr = load;
+        tlb_packet.rob_index = 0;
+        tlb_packet.ip = load_ip;
+        tlb_packet.type = LOAD;
+        tlb_packet.asid[0] = 0;
+        tlb_packet.asid[1] = 0;
+        tlb_packet.event_cycle = current_core_cycle[cpu];
+        tlb_packet.wrong_path = 1;
+
+        DTLB.add_rq(&tlb_packet);
+    }
+
+    wrong_path.advance();
+}
+
 void O3_CPU::decode_and_dispatch()
 {
   // dispatch DECODE_WIDTH instructions that have decoded into the ROB
@@ -737,6 +647,12 @@ void O3_CPU::decode_and_dispatch()
       if(((!warmup_complete[cpu]) && (ROB.occupancy < ROB.SIZE)) ||
 	 ((DECODE_BUFFER.entry[DECODE_BUFFER.head].event_cycle != 0) && (DECODE_BUFFER.entry[DECODE_BUFFER.head].event_cycle < current_core_cycle[cpu]) && (ROB.occupancy < ROB.SIZE)))
 	{
+	  // a taken branch the BTB missed is found now, so fetch can restart at its target
+	  if (DECODE_BUFFER.entry[DECODE_BUFFER.head].branch_redirect == REDIRECT_DECODE)
+	    {
+	      fetch_resume_cycle = current_core_cycle[cpu] + BTB_MISS_PENALTY;
+	    }
+
 	  // move this instruction to the ROB if there's space
 	  uint32_t rob_index = add_to_rob(&DECODE_BUFFER.entry[DECODE_BUFFER.head]);
 	  ROB.entry[rob_index].event_cycle = current_core_cycle[cpu];
@@ -806,6 +722,11 @@ int O3_CPU::prefetch_code_line(uint64_t pf_v_addr)
     }
   
   L1I.pf_requested++;
+  if (L1I.PQ.occupancy == L1I.PQ.SIZE)
+    {
+      L1I.pf_timeliness.dropped++;
+      L1I.pf_base_timeliness.dropped++;
+    }
 
   if (L1I.PQ.occupancy < L1I.PQ.SIZE)
     {
@@ -826,9 +747,12 @@ int O3_CPU::prefetch_code_line(uint64_t pf_v_addr)
       pf_packet.ip = pf_v_addr;
       pf_packet.type = PREFETCH;
       pf_packet.event_cycle = current_core_cycle[cpu];
+      pf_packet.pf_source = &L1I.pf_base_timeliness;
 
       L1I.add_pq(&pf_packet);    
       L1I.pf_issued++;
+      L1I.pf_timeliness.issued++;
+      L1I.pf_base_timeliness.issued++;
     
       return 1;
     }
@@ -1707,8 +1631,10 @@ int O3_CPU::execute_load(uint32_t rob_index, uint32_t lq_index, uint32_t data_in
 
     if (rq_index == -2)
         return rq_index;
-    else 
+    else {
         LQ.entry[lq_index].fetched = INFLIGHT;
+        LQ.entry[lq_index].issue_cycle = current_core_cycle[cpu];
+    }
 
     return rq_index;
 }
@@ -1853,6 +1779,14 @@ void O3_CPU::complete_instr_fetch(PACKET_QUEUE *queue, uint8_t is_it_tlb)
 
     uint64_t complete_ip = queue->entry[index].ip;
 
+    // the instructions were translated when they entered the IFETCH_BUFFER, so a wrong-path
+    // translation must not send them back to the L1I
+    if(is_it_tlb && queue->entry[index].wrong_path)
+      {
+	queue->remove_queue(&queue->entry[index]);
+	return;
+      }
+
     if(is_it_tlb)
       {
 	uint64_t instruction_physical_address = (queue->entry[index].instruction_pa << LOG2_PAGE_SIZE) | (complete_ip & ((1 << LOG2_PAGE_SIZE) - 1));
@@ -1860,7 +1794,7 @@ void O3_CPU::complete_instr_fetch(PACKET_QUEUE *queue, uint8_t is_it_tlb)
 	// mark the appropriate instructions in the IFETCH_BUFFER as translated and ready to fetch
 	for(uint32_t j=0; j<IFETCH_BUFFER.SIZE; j++)
 	  {
-	    if(((IFETCH_BUFFER.entry[j].ip)>>LOG2_PAGE_SIZE) == ((complete_ip)>>LOG2_PAGE_SIZE))
+	    if((((IFETCH_BUFFER.entry[j].ip)>>LOG2_PAGE_SIZE) == ((complete_ip)>>LOG2_PAGE_SIZE)) && (IFETCH_BUFFER.entry[j].uop_cache_hit == 0))
 	      {
 		IFETCH_BUFFER.entry[j].translated = COMPLETED;
 		// we did not fetch this instruction's cache line, but we did translated it
@@ -1947,6 +1881,40 @@ void O3_CPU::complete_data_fetch(PACKET_QUEUE *queue, uint8_t is_it_tlb)
              sq_index = queue->entry[index].sq_index,
              lq_index = queue->entry[index].lq_index;
 
+    // no load waits for a wrong-path load, but the ones that merged with it do
+    if (queue->entry[index].wrong_path) {
+        if (is_it_tlb) {
+            handle_merged_translation(&queue->entry[index]);
+
+            // the translated load goes on to the L1D, unless the branch was resolved meanwhile
+            if (wrong_path.active && (L1D.RQ.occupancy < L1D.RQ.SIZE) && (L1D.PROCESSED.occupancy < (L1D.PROCESSED.SIZE / 2))) {
+                uint64_t load_pa = (queue->entry[index].data_pa << LOG2_PAGE_SIZE) | (queue->entry[index].full_addr & ((1 << LOG2_PAGE_SIZE) - 1));
+
+                PACKET data_packet;
+                data_packet.fill_level = FILL_L1;
+                data_packet.fill_l1d = 1;
+                data_packet.cpu = cpu;
+                data_packet.address = load_pa >> LOG2_BLOCK_SIZE;
+                data_packet.full_addr = load_pa;
+                data_packet.rob_index = 0;
+                data_packet.ip = queue->entry[index].ip;
+                data_packet.type = LOAD;
+                data_packet.asid[0] = 0;
+                data_packet.asid[1] = 0;
+                data_packet.event_cycle = current_core_cycle[cpu];
+                data_packet.wrong_path = 1;
+
+                if (L1D.add_rq(&data_packet) != -2)
+                    wrong_path.loads_issued++;
+            }
+        }
+        else
+            handle_merged_load(&queue->entry[index]);
+
+        queue->remove_queue(&queue->entry[index]);
+        return;
+    }
+
 #ifdef SANITY_CHECK
     if (queue->entry[index].type != RFO) {
         if (rob_index != check_rob(queue->entry[index].instr_id))
@@ -2011,6 +1979,8 @@ void O3_CPU::complete_data_fetch(PACKET_QUEUE *queue, uint8_t is_it_tlb)
 #endif
             LQ.entry[lq_index].fetched = COMPLETED;
             LQ.entry[lq_index].event_cycle = current_core_cycle[cpu];
+            if (warmup_complete[cpu] && !simulation_complete[cpu] && LQ.entry[lq_index].issue_cycle)
+                load_latency.add(current_core_cycle[cpu] - LQ.entry[lq_index].issue_cycle);
             ROB.entry[rob_index].num_mem_ops--;
             ROB.entry[rob_index].event_cycle = queue->entry[index].event_cycle;
 
@@ -2180,6 +2150,8 @@ void O3_CPU::handle_merged_load(PACKET *provider)
 
         LQ.entry[merged].fetched = COMPLETED;
         LQ.entry[merged].event_cycle = current_core_cycle[cpu];
+        if (warmup_complete[cpu] && !simulation_complete[cpu] && LQ.entry[merged].issue_cycle)
+            load_latency.add(current_core_cycle[cpu] - LQ.entry[merged].issue_cycle);
         ROB.entry[merged_rob_index].num_mem_ops--;
         ROB.entry[merged_rob_index].event_cycle = current_core_cycle[cpu];
 
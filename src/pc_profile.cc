@@ -0,0 +1,114 @@
+#include "pc_profile.h"
+
+#include <algorithm>
+
+PC_PROFILE_ENTRY *PC_PROFILER::find(uint32_t cpu, uint64_t ip)
+{
+    // only the region of interest is profiled
+    if ((warmup_complete[cpu] == 0) || simulation_complete[cpu] || (ip == 0))
+        return NULL;
+
+    // fibonacci hashing spreads the (mostly sequential) PCs over the table
+    uint32_t slot = (ip * 0x9E3779B97F4A7C15ull) >> (64 - const_lg2(PC_PROFILE_SIZE));
+
+    for (uint32_t i=0; i<PC_PROFILE_SIZE; i++) {
+        PC_PROFILE_ENTRY *entry = &table[cpu][slot];
+        if (entry->ip == ip)
+            return entry;
+
+        if (entry->ip == 0) {
+            if (occupancy[cpu] == PC_PROFILE_MAX_OCCUPANCY)
+                break;
+
+            entry->ip = ip;
+            occupancy[cpu]++;
+            return entry;
+        }
+
+        slot = (slot + 1) & (PC_PROFILE_SIZE - 1);
+    }
+
+    untracked[cpu]++;
+    return NULL;
+}
+
+void PC_PROFILER::access(uint32_t cpu, uint8_t level, uint64_t ip, uint8_t hit, uint8_t prefetched)
+{
+    PC_PROFILE_ENTRY *entry = find(cpu, ip);
+    if (entry == NULL)
+        return;
+
+    if (level == IS_L1D)
+        entry->access++;
+    if (hit == 0)
+        entry->miss[level - IS_L1D]++;
+    else if (prefetched)
+        entry->pf_hit++;
+}
+
+void PC_PROFILER::late_prefetch(uint32_t cpu, uint8_t level, uint64_t ip)
+{
+    PC_PROFILE_ENTRY *entry = find(cpu, ip);
+    if (entry)
+        entry->pf_late++;
+}
+
+void PC_PROFILER::fill(uint32_t cpu, uint8_t level, uint64_t ip, uint64_t latency)
+{
+    // the L1D miss latency already includes the time spent in the lower levels
+    if (level != IS_L1D)
+        return;
+
+    PC_PROFILE_ENTRY *entry = find(cpu, ip);
+    if (entry)
+        entry->miss_latency += latency;
+}
+
+void PC_PROFILER::reset_stats()
+{
+    for (uint32_t i=0; i<NUM_CPUS; i++) {
+        for (uint32_t j=0; j<PC_PROFILE_SIZE; j++)
+            table[i][j].clear();
+
+        occupancy[i] = 0;
+        untracked[i] = 0;
+    }
+}
+
+void PC_PROFILER::print_stats()
+{
+    cout << endl;
+    cout << "Per-PC Load Profile (top " << PC_PROFILE_TOP << " PCs by L1D miss latency)" << endl;
+
+    for (uint32_t i=0; i<NUM_CPUS; i++) {
+        vector<PC_PROFILE_ENTRY*> sorted;
+        uint64_t total_latency = 0;
+
+        for (uint32_t j=0; j<PC_PROFILE_SIZE; j++) {
+            if (table[i][j].ip) {
+                sorted.push_back(&table[i][j]);
+                total_latency += table[i][j].miss_latency;
+            }
+        }
+
+        uint32_t top = (sorted.size() < PC_PROFILE_TOP) ? sorted.size() : PC_PROFILE_TOP;
+        partial_sort(sorted.begin(), sorted.begin() + top, sorted.end(),
+                     [](const PC_PROFILE_ENTRY *a, const PC_PROFILE_ENTRY *b) {
+                         return (a->miss_latency != b->miss_latency) ? (a->miss_latency > b->miss_latency) : (a->ip < b->ip);
+                     });
+
+        cout << " CPU " << i << " PCS: " << occupancy[i] << "  UNTRACKED_ACCESS: " << untracked[i];
+        cout << "  TOTAL_MISS_LATENCY: " << total_latency << endl;
+
+        for (uint32_t j=0; j<top; j++) {
+            PC_PROFILE_ENTRY *entry = sorted[j];
+            cout << "  IP: 0x" << hex << setw(12) << setfill('0') << entry->ip << dec << setfill(' ');
+            cout << "  ACCESS: " << setw(10) << entry->access;
+            cout << "  L1D_MISS: " << setw(10) << entry->miss[0] << "  L2C_MISS: " << setw(10) << entry->miss[1];
+            cout << "  LLC_MISS: " << setw(10) << entry->miss[2];
+            cout << "  PF_HIT: " << setw(10) << entry->pf_hit << "  PF_LATE: " << setw(10) << entry->pf_late;
+            cout << "  AVERAGE_MISS_LATENCY: " << setw(8) << (entry->miss[0] ? ((double) entry->miss_latency / entry->miss[0]) : 0);
+            cout << "  STALL_SHARE: " << setw(8) << (total_latency ? ((100.0 * entry->miss_latency) / total_latency) : 0) << "%" << endl;
+        }
+    }
+}
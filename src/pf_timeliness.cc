@@ -0,0 +1,22 @@
+#include "pf_timeliness.h"
+
+void PF_TIMELINESS::reset()
+{
+    issued = 0;
+    timely = 0;
+    late = 0;
+    dropped = 0;
+    redundant = 0;
+    useless = 0;
+    cross_page = 0;
+    earliness.reset();
+}
+
+void PF_TIMELINESS::print(string name)
+{
+    cout << name << "  ISSUED: " << setw(10) << issued << "  TIMELY: " << setw(10) << timely << "  LATE: " << setw(10) << late;
+    cout << "  DROPPED: " << setw(10) << dropped << "  REDUNDANT: " << setw(10) << redundant << "  USELESS: " << setw(10) << useless;
+    cout << "  CROSS_PAGE: " << setw(10) << cross_page << endl;
+
+    earliness.print(name + " EARLINESS");
+}
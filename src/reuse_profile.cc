@@ -0,0 +1,133 @@
+#include "reuse_profile.h"
+
+#include <algorithm>
+
+void REUSE_PROFILER::init(uint32_t rate)
+{
+    sample_rate = rate;
+    now = 0;
+    size = REUSE_INITIAL_SIZE;
+    tree.assign(size + 1, 0);
+    last_access.clear();
+
+    reset_stats();
+}
+
+void REUSE_PROFILER::mark(uint64_t time, int32_t delta)
+{
+    for (uint64_t i=time+1; i<=size; i+=(i & -i))
+        tree[i] += delta;
+}
+
+uint64_t REUSE_PROFILER::count(uint64_t time)
+{
+    uint64_t sum = 0;
+    for (uint64_t i=time+1; i>0; i-=(i & -i))
+        sum += tree[i];
+
+    return sum;
+}
+
+void REUSE_PROFILER::compact()
+{
+    // renumber the live blocks 0..n-1 in the order of their last access, which keeps every distance
+    vector<pair<uint64_t, uint64_t>> live;
+    live.reserve(last_access.size());
+    for (auto &it : last_access)
+        live.push_back(make_pair(it.second, it.first));
+    sort(live.begin(), live.end());
+
+    // grow while more than half of the timestamps belong to live blocks
+    while (live.size() > size/2)
+        size *= 2;
+    tree.assign(size + 1, 0);
+
+    for (now=0; now<live.size(); now++) {
+        last_access[live[now].second] = now;
+        mark(now, 1);
+    }
+}
+
+void REUSE_PROFILER::access_block(uint64_t address, uint8_t record)
+{
+    // SHARDS sampling on a hash of the block address
+    if ((sample_rate > 1) && (((address * 0x9E3779B97F4A7C15ull) >> 32) % sample_rate))
+        return;
+
+    auto it = last_access.find(address);
+    if (it == last_access.end()) {
+        if (record) {
+            access++;
+            cold++;
+        }
+        last_access[address] = now;
+    }
+    else {
+        if (record) {
+            uint64_t distance = count(now-1) - count(it->second);
+            histogram[bucket(distance * sample_rate)]++;
+            access++;
+        }
+        mark(it->second, -1);
+        it->second = now;
+    }
+
+    mark(now, 1);
+    now++;
+
+    if (now == size)
+        compact();
+}
+
+uint32_t REUSE_PROFILER::bucket(uint64_t distance)
+{
+    const uint32_t lg2_sub = const_lg2(REUSE_SUB_BUCKETS);
+
+    if (distance < REUSE_SUB_BUCKETS)
+        return distance;
+
+    // the leading bit picks the power of two, the next lg2_sub bits the sub-bucket
+    uint32_t msb = 63 - __builtin_clzll(distance),
+             index = REUSE_SUB_BUCKETS + (msb - lg2_sub)*REUSE_SUB_BUCKETS + ((distance >> (msb - lg2_sub)) & (REUSE_SUB_BUCKETS - 1));
+
+    return (index < REUSE_BUCKETS) ? index : (REUSE_BUCKETS - 1);
+}
+
+uint64_t REUSE_PROFILER::bucket_floor(uint32_t bucket)
+{
+    if (bucket < REUSE_SUB_BUCKETS)
+        return bucket;
+
+    uint32_t octave = (bucket - REUSE_SUB_BUCKETS) / REUSE_SUB_BUCKETS,
+             sub = (bucket - REUSE_SUB_BUCKETS) % REUSE_SUB_BUCKETS;
+
+    return ((uint64_t) (REUSE_SUB_BUCKETS + sub)) << octave;
+}
+
+void REUSE_PROFILER::reset_stats()
+{
+    access = 0;
+    cold = 0;
+    for (uint32_t i=0; i<REUSE_BUCKETS; i++)
+        histogram[i] = 0;
+}
+
+void REUSE_PROFILER::print_stats(string name, uint32_t num_line)
+{
+    if (!enabled())
+        return;
+
+    cout << name << " REUSE PROFILE  ACCESS: " << setw(10) << access << "  COLD: " << setw(10) << cold;
+    cout << "  SAMPLE_RATE: 1/" << sample_rate << "  TRACKED_BLOCKS: " << last_access.size() << endl;
+
+    // fully associative LRU miss ratio of every bucket boundary around the size of this cache
+    uint64_t misses = access;
+    for (uint32_t i=0; i<REUSE_BUCKETS; i++) {
+        uint64_t lines = bucket_floor(i);
+        if ((lines >= (num_line / REUSE_MRC_RANGE)) && (lines <= ((uint64_t) num_line * REUSE_MRC_RANGE)) && (lines > 0)) {
+            cout << name << " MRC  SIZE: " << setw(10) << lines << " blocks (" << setw(8) << (lines*BLOCK_SIZE)/1024 << " KB)";
+            cout << "  MISS_RATIO: " << setw(8) << (access ? ((double) misses / access) : 0) << ((lines == num_line) ? "  <- " + name : "") << endl;
+        }
+        misses -= histogram[i];
+    }
+}
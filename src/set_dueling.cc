@@ -0,0 +1,151 @@
+#include "set_dueling.h"
+
+void select_sets(uint8_t selection, uint32_t num_set, uint32_t count, uint32_t *sets)
+{
+    if (count > num_set) {
+        cerr << "cannot select " << count << " sets out of " << num_set << endl;
+        assert(0);
+    }
+
+    if (selection == LEADER_STRIDED) {
+        // one set out of every stride, moving one set further into the stride each time
+        uint32_t stride = num_set / count;
+        for (uint32_t i=0; i<count; i++)
+            sets[i] = i*stride + (i % stride);
+
+        return;
+    }
+
+    // LEADER_RANDOM
+    unsigned long rand_seed = 1;
+    unsigned long max_rand = 1048576;
+    for (uint32_t i=0; i<count; i++) {
+        uint8_t do_again;
+        do {
+            do_again = 0;
+            rand_seed = rand_seed * 1103515245 + 12345;
+            sets[i] = ((unsigned) ((rand_seed/65536) % max_rand)) % num_set;
+            for (uint32_t j=0; j<i; j++) {
+                if (sets[i] == sets[j]) {
+                    do_again = 1;
+                    break;
+                }
+            }
+        } while (do_again);
+    }
+}
+
+void SET_DUELING::init(uint32_t v1, uint32_t v2, uint32_t psel_width, uint8_t selection, uint32_t num_cpus)
+{
+    num_set = v1;
+    leader_sets = v2;
+    psel_max = (1 << psel_width) - 1;
+
+    delete[] leader_policy;
+    delete[] leader_cpu;
+    leader_policy = new int8_t[num_set];
+    leader_cpu = new uint8_t[num_set];
+    for (uint32_t i=0; i<num_set; i++) {
+        leader_policy[i] = -1;
+        leader_cpu[i] = 0;
+    }
+
+    // cpu 0 policy 0, cpu 0 policy 1, cpu 1 policy 0, ...
+    uint32_t count = num_cpus * 2 * leader_sets;
+    uint32_t *sets = new uint32_t[count];
+    select_sets(selection, num_set, count, sets);
+    for (uint32_t i=0; i<count; i++) {
+        leader_cpu[sets[i]] = i / (2*leader_sets);
+        leader_policy[sets[i]] = (i % (2*leader_sets)) / leader_sets;
+    }
+    delete[] sets;
+
+    for (uint32_t i=0; i<NUM_CPUS; i++)
+        psel[i] = 0;
+}
+
+void REPL_SAMPLER::init(uint32_t v1, uint32_t v2, uint32_t v3, uint8_t selection)
+{
+    num_set = v1;
+    num_sampled = v2;
+    num_way = v3;
+
+    delete[] sampled;
+    delete[] entry;
+    sampled = new int32_t[num_set];
+    entry = new SAMPLER_ENTRY[num_sampled*num_way];
+
+    for (uint32_t i=0; i<num_set; i++)
+        sampled[i] = -1;
+
+    uint32_t *sets = new uint32_t[num_sampled];
+    select_sets(selection, num_set, num_sampled, sets);
+    for (uint32_t i=0; i<num_sampled; i++) {
+        sampled[sets[i]] = i;
+        for (uint32_t j=0; j<num_way; j++)
+            entry[i*num_way + j].lru = j;
+    }
+    delete[] sets;
+}
+
+void REPL_SAMPLER::access(uint32_t cpu, uint32_t set, uint64_t full_addr, uint64_t ip, uint8_t type)
+{
+    if (!is_sampled(set))
+        return;
+
+    SAMPLER_ENTRY *s_set = &entry[sampled[set]*num_way];
+    uint64_t address = full_addr >> LOG2_BLOCK_SIZE;
+    uint32_t match;
+
+    // check hit
+    for (match=0; match<num_way; match++) {
+        if (s_set[match].valid && (s_set[match].address == address)) {
+            if (observe_hit)
+                observe_hit(cpu, s_set[match]);
+
+            s_set[match].type = type;
+            s_set[match].used = 1;
+            break;
+        }
+    }
+
+    // fill an invalid entry, otherwise replace the LRU entry
+    if (match == num_way) {
+        for (match=0; match<num_way; match++) {
+            if (s_set[match].valid == 0)
+                break;
+        }
+
+        if (match == num_way) {
+            for (match=0; match<num_way; match++) {
+                if (s_set[match].lru == (num_way-1))
+                    break;
+            }
+
+#ifdef SANITY_CHECK
+            if (match == num_way) {
+                cerr << "[REPL_SAMPLER] " << __func__ << " no victim! set: " << set << endl;
+                assert(0);
+            }
+#endif
+
+            if (observe_evict)
+                observe_evict(cpu, s_set[match]);
+        }
+
+        s_set[match].valid = 1;
+        s_set[match].address = address;
+        s_set[match].ip = ip;
+        s_set[match].type = type;
+        s_set[match].used = 0;
+        s_set[match].cpu = cpu;
+    }
+
+    // update LRU state
+    uint32_t curr_position = s_set[match].lru;
+    for (uint32_t i=0; i<num_way; i++) {
+        if (s_set[i].lru < curr_position)
+            s_set[i].lru++;
+    }
+    s_set[match].lru = 0;
+}
@@ -0,0 +1,298 @@
+#include <fstream>
+
+#include "trace_reader.h"
+
+void TRACE_READER::open(uint32_t trace_cpu, const char *trace_name, uint8_t cloudsuite_trace)
+{
+    cpu = trace_cpu;
+    cloudsuite = cloudsuite_trace;
+    num_read = 0;
+
+    sprintf(trace_string, "%s", trace_name);
+
+    std::string full_name(trace_name);
+    std::string last_dot = full_name.substr(full_name.find_last_of("."));
+
+    std::string fmtstr;
+    std::string decomp_program;
+    if (full_name.substr(0,4) == "http")
+    {
+        // Check file exists
+        char testfile_command[4096];
+        sprintf(testfile_command, "wget -q --spider %s", trace_name);
+        FILE *testfile = popen(testfile_command, "r");
+        if (pclose(testfile))
+        {
+            std::cerr << "TRACE FILE NOT FOUND" << std::endl;
+            assert(0);
+        }
+        fmtstr = "wget -qO- %2$s | %1$s -dc";
+    }
+    else
+    {
+        std::ifstream testfile(trace_name);
+        if (!testfile.good())
+        {
+            std::cerr << "TRACE FILE NOT FOUND" << std::endl;
+            assert(0);
+        }
+        fmtstr = "%1$s -dc %2$s";
+    }
+
+    if (last_dot[1] == 'g') // gzip format
+        decomp_program = "gzip";
+    else if (last_dot[1] == 'x') // xz
+        decomp_program = "xz";
+    else {
+        std::cout << "ChampSim does not support traces other than gz or xz compression!" << std::endl;
+        assert(0);
+    }
+
+    sprintf(gunzip_command, fmtstr.c_str(), decomp_program.c_str(), trace_name);
+
+    trace_file = popen(gunzip_command, "r");
+    if (trace_file == NULL) {
+        printf("\n*** Trace file not found: %s ***\n\n", trace_name);
+        assert(0);
+    }
+}
+
+uint8_t TRACE_READER::read(ooo_model_instr *decoded_instr)
+{
+    size_t instr_size = cloudsuite ? sizeof(cloudsuite_instr) : sizeof(input_instr);
+
+    if (cloudsuite) {
+        if (!fread(&current_cloudsuite_instr, instr_size, 1, trace_file)) {
+            // reached end of file for this trace
+            cout << "*** Reached end of trace for Core: " << cpu << " Repeating trace: " << trace_string << endl; 
+
+            // close the trace file and re-open it
+            pclose(trace_file);
+            trace_file = popen(gunzip_command, "r");
+            if (trace_file == NULL) {
+                cerr << endl << "*** CANNOT REOPEN TRACE FILE: " << trace_string << " ***" << endl;
+                assert(0);
+            }
+            return 0;
+        }
+
+        // copy the instruction into the performance model's instruction format
+        ooo_model_instr arch_instr;
+        int num_reg_ops = 0, num_mem_ops = 0;
+
+        arch_instr.ip = current_cloudsuite_instr.ip;
+        arch_instr.is_branch = current_cloudsuite_instr.is_branch;
+        arch_instr.branch_taken = current_cloudsuite_instr.branch_taken;
+
+        arch_instr.asid[0] = current_cloudsuite_instr.asid[0];
+        arch_instr.asid[1] = current_cloudsuite_instr.asid[1];
+
+        for (uint32_t i=0; i<NUM_INSTR_DESTINATIONS_SPARC; i++) {
+            arch_instr.destination_registers[i] = current_cloudsuite_instr.destination_registers[i];
+            arch_instr.destination_memory[i] = current_cloudsuite_instr.destination_memory[i];
+            arch_instr.destination_virtual_address[i] = current_cloudsuite_instr.destination_memory[i];
+
+            if (arch_instr.destination_registers[i])
+                num_reg_ops++;
+            if (arch_instr.destination_memory[i])
+                num_mem_ops++;
+        }
+
+        for (int i=0; i<NUM_INSTR_SOURCES; i++) {
+            arch_instr.source_registers[i] = current_cloudsuite_instr.source_registers[i];
+            arch_instr.source_memory[i] = current_cloudsuite_instr.source_memory[i];
+            arch_instr.source_virtual_address[i] = current_cloudsuite_instr.source_memory[i];
+
+            if (arch_instr.source_registers[i])
+                num_reg_ops++;
+            if (arch_instr.source_memory[i])
+                num_mem_ops++;
+        }
+
+        arch_instr.num_reg_ops = num_reg_ops;
+        arch_instr.num_mem_ops = num_mem_ops;
+        if (num_mem_ops > 0) 
+            arch_instr.is_memory = 1;
+
+        *decoded_instr = arch_instr;
+        num_read++;
+        return 1;
+    }
+
+    input_instr trace_read_instr;
+    if (!fread(&trace_read_instr, instr_size, 1, trace_file)) {
+        // reached end of file for this trace
+        cout << "*** Reached end of trace for Core: " << cpu << " Repeating trace: " << trace_string << endl; 
+
+        // close the trace file and re-open it
+        pclose(trace_file);
+        trace_file = popen(gunzip_command, "r");
+        if (trace_file == NULL) {
+            cerr << endl << "*** CANNOT REOPEN TRACE FILE: " << trace_string << " ***" << endl;
+            assert(0);
+        }
+        return 0;
+    }
+
+    if(num_read == 0)
+      {
+        current_instr = next_instr = trace_read_instr;
+      }
+    else
+      {
+        current_instr = next_instr;
+        next_instr = trace_read_instr;
+      }
+
+    // copy the instruction into the performance model's instruction format
+    ooo_model_instr arch_instr;
+    int num_reg_ops = 0, num_mem_ops = 0;
+
+    arch_instr.ip = current_instr.ip;
+    arch_instr.is_branch = current_instr.is_branch;
+    arch_instr.branch_taken = current_instr.branch_taken;
+
+    arch_instr.asid[0] = cpu;
+    arch_instr.asid[1] = cpu;
+
+    bool reads_sp = false;
+    bool writes_sp = false;
+    bool reads_flags = false;
+    bool reads_ip = false;
+    bool writes_ip = false;
+    bool reads_other = false;
+
+    for (uint32_t i=0; i<NUM_INSTR_DESTINATIONS; i++) {
+        arch_instr.destination_registers[i] = current_instr.destination_registers[i];
+        arch_instr.destination_memory[i] = current_instr.destination_memory[i];
+        arch_instr.destination_virtual_address[i] = current_instr.destination_memory[i];
+
+        switch(arch_instr.destination_registers[i])
+          {
+          case 0:
+            break;
+          case REG_STACK_POINTER:
+            writes_sp = true;
+            break;
+          case REG_INSTRUCTION_POINTER:
+            writes_ip = true;
+            break;
+          default:
+            break;
+          }
+
+        /*
+        if((arch_instr.is_branch) && (arch_instr.destination_registers[i] > 24) && (arch_instr.destination_registers[i] < 28))
+          {
+            arch_instr.destination_registers[i] = 0;
+          }
+        */
+
+        if (arch_instr.destination_registers[i])
+            num_reg_ops++;
+        if (arch_instr.destination_memory[i])
+            num_mem_ops++;
+    }
+
+    for (int i=0; i<NUM_INSTR_SOURCES; i++) {
+        arch_instr.source_registers[i] = current_instr.source_registers[i];
+        arch_instr.source_memory[i] = current_instr.source_memory[i];
+        arch_instr.source_virtual_address[i] = current_instr.source_memory[i];
+
+        switch(arch_instr.source_registers[i])
+          {
+          case 0:
+            break;
+          case REG_STACK_POINTER:
+            reads_sp = true;
+            break;
+          case REG_FLAGS:
+            reads_flags = true;
+            break;
+          case REG_INSTRUCTION_POINTER:
+            reads_ip = true;
+            break;
+          default:
+            reads_other = true;
+            break;
+          }
+
+        /*
+        if((!arch_instr.is_branch) && (arch_instr.source_registers[i] > 25) && (arch_instr.source_registers[i] < 28))
+          {
+            arch_instr.source_registers[i] = 0;
+          }
+        */
+
+        if (arch_instr.source_registers[i])
+            num_reg_ops++;
+        if (arch_instr.source_memory[i])
+            num_mem_ops++;
+    }
+
+    arch_instr.num_reg_ops = num_reg_ops;
+    arch_instr.num_mem_ops = num_mem_ops;
+    if (num_mem_ops > 0)
+        arch_instr.is_memory = 1;
+
+    // determine what kind of branch this is, if any
+    if(!reads_sp && !reads_flags && writes_ip && !reads_other)
+      {
+        // direct jump
+        arch_instr.is_branch = 1;
+        arch_instr.branch_taken = 1;
+        arch_instr.branch_type = BRANCH_DIRECT_JUMP;
+      }
+    else if(!reads_sp && !reads_flags && writes_ip && reads_other)
+      {
+        // indirect branch
+        arch_instr.is_branch = 1;
+        arch_instr.branch_taken = 1;
+        arch_instr.branch_type = BRANCH_INDIRECT;
+      }
+    else if(!reads_sp && reads_ip && !writes_sp && writes_ip && reads_flags && !reads_other)
+      {
+        // conditional branch
+        arch_instr.is_branch = 1;
+        arch_instr.branch_taken = arch_instr.branch_taken; // don't change this
+        arch_instr.branch_type = BRANCH_CONDITIONAL;
+      }
+    else if(reads_sp && reads_ip && writes_sp && writes_ip && !reads_flags && !reads_other)
+      {
+        // direct call
+        arch_instr.is_branch = 1;
+        arch_instr.branch_taken = 1;
+        arch_instr.branch_type = BRANCH_DIRECT_CALL;
+      }
+    else if(reads_sp && reads_ip && writes_sp && writes_ip && !reads_flags && reads_other)
+      {
+        // indirect call
+        arch_instr.is_branch = 1;
+        arch_instr.branch_taken = 1;
+        arch_instr.branch_type = BRANCH_INDIRECT_CALL;
+      }
+    else if(reads_sp && !reads_ip && writes_sp && writes_ip)
+      {
+        // return
+        arch_instr.is_branch = 1;
+        arch_instr.branch_taken = 1;
+        arch_instr.branch_type = BRANCH_RETURN;
+      }
+    else if(writes_ip)
+      {
+        // some other branch type that doesn't fit the above categories
+        arch_instr.is_branch = 1;
+        arch_instr.branch_taken = arch_instr.branch_taken; // don't change this
+        arch_instr.branch_type = BRANCH_OTHER;
+      }
+
+
+    if((arch_instr.is_branch == 1) && (arch_instr.branch_taken == 1))
+      {
+        arch_instr.branch_target = next_instr.ip;
+      }
+
+    *decoded_instr = arch_instr;
+    num_read++;
+    return 1;
+}
@@ -0,0 +1,165 @@
+#include "ucp.h"
+
+void UCP::observe(uint32_t cpu, uint64_t address)
+{
+    // dynamic set sampling: only every UMON_STRIDE-th LLC set is monitored
+    uint32_t set = address % (LLC_SET);
+    if (set % UMON_STRIDE)
+        return;
+
+    UMON_ENTRY *s_set = atd[cpu][set / UMON_STRIDE];
+    uint32_t way;
+
+    umon_access[cpu]++;
+
+    for (way=0; way<LLC_WAY; way++) {
+        if (s_set[way].valid && (s_set[way].address == address)) {
+            // a hit at stack position p would have hit with any allocation larger than p ways
+            way_hit[cpu][s_set[way].lru]++;
+            umon_hit[cpu]++;
+            break;
+        }
+    }
+
+    // miss: replace the LRU shadow tag
+    if (way == LLC_WAY) {
+        for (way=0; way<LLC_WAY; way++) {
+            if (s_set[way].lru == LLC_WAY-1)
+                break;
+        }
+
+#ifdef SANITY_CHECK
+        if (way == LLC_WAY) {
+            cerr << "[" << NAME << "] " << __func__ << " no victim! set: " << set << endl;
+            assert(0);
+        }
+#endif
+
+        s_set[way].valid = 1;
+        s_set[way].address = address;
+    }
+
+    for (uint32_t i=0; i<LLC_WAY; i++) {
+        if (s_set[i].lru < s_set[way].lru)
+            s_set[i].lru++;
+    }
+    s_set[way].lru = 0;
+}
+
+void UCP::operate(uint64_t cycle)
+{
+    if (cycle < next_repartition)
+        return;
+
+    next_repartition = cycle + UCP_EPOCH;
+    lookahead();
+}
+
+void UCP::lookahead()
+{
+    // lookahead allocation (Qureshi and Patt, MICRO 2006): every cpu keeps one way, and the
+    // remaining ways go one chunk at a time to the cpu with the highest marginal utility per way
+    uint32_t balance = LLC_WAY - NUM_CPUS;
+    for (uint32_t i=0; i<NUM_CPUS; i++)
+        allocation[i] = 1;
+
+    while (balance) {
+        uint32_t winner = 0, winner_ways = 1;
+        double winner_utility = -1;
+
+        for (uint32_t i=0; i<NUM_CPUS; i++) {
+            uint64_t hits = 0;
+            for (uint32_t j=1; j<=balance; j++) {
+                hits += way_hit[i][allocation[i]+j-1];
+
+                double utility = (double) hits / j;
+                if (utility > winner_utility) {
+                    winner = i;
+                    winner_ways = j;
+                    winner_utility = utility;
+                }
+            }
+        }
+
+        allocation[winner] += winner_ways;
+        balance -= winner_ways;
+    }
+
+    // age the counters so the next epoch weighs recent behavior more
+    for (uint32_t i=0; i<NUM_CPUS; i++) {
+        for (uint32_t j=0; j<LLC_WAY; j++)
+            way_hit[i][j] /= 2;
+
+        allocated_ways[i] += allocation[i];
+    }
+    repartition++;
+
+    DP ( if (warmup_complete[0]) {
+    cout << "[" << NAME << "] " << __func__ << " allocation:";
+    for (uint32_t i=0; i<NUM_CPUS; i++)
+        cout << " " << allocation[i];
+    cout << endl; });
+}
+
+uint64_t UCP::victim_mask(uint32_t cpu, const BLOCK *current_set)
+{
+    uint64_t invalid = 0, own = 0, over = 0;
+    uint32_t occupancy[NUM_CPUS];
+
+    for (uint32_t i=0; i<NUM_CPUS; i++)
+        occupancy[i] = 0;
+
+    for (uint32_t way=0; way<LLC_WAY; way++) {
+        if (current_set[way].valid == 0)
+            invalid |= (1ull << way);
+        else
+            occupancy[current_set[way].cpu]++;
+    }
+
+    // the set is not full yet, nobody has to lose a block
+    if (invalid)
+        return invalid;
+
+    for (uint32_t way=0; way<LLC_WAY; way++) {
+        uint32_t owner = current_set[way].cpu;
+        if (owner == cpu)
+            own |= (1ull << way);
+        if (occupancy[owner] > allocation[owner])
+            over |= (1ull << way);
+    }
+
+    // below its quota the cpu takes a way from a cpu above its quota, otherwise it replaces its own
+    if ((occupancy[cpu] < allocation[cpu]) && over)
+        return over;
+    if (own)
+        return own;
+    if (over)
+        return over;
+
+    return ~0ull >> (64 - LLC_WAY);
+}
+
+void UCP::reset_stats()
+{
+    repartition = 0;
+    victim_override = 0;
+
+    for (uint32_t i=0; i<NUM_CPUS; i++) {
+        umon_access[i] = 0;
+        umon_hit[i] = 0;
+        allocated_ways[i] = 0;
+    }
+}
+
+void UCP::print_stats()
+{
+    cout << endl;
+    cout << "LLC Partitioning Statistics" << endl;
+    cout << " REPARTITION: " << setw(10) << repartition << "  VICTIM_OVERRIDE: " << setw(10) << victim_override << endl;
+
+    for (uint32_t i=0; i<NUM_CPUS; i++) {
+        cout << " CPU " << i << " WAYS: " << setw(2) << allocation[i];
+        cout << "  AVERAGE_WAYS: " << setw(6) << (repartition ? ((double) allocated_ways[i] / repartition) : allocation[i]);
+        cout << "  UMON_ACCESS: " << setw(10) << umon_access[i] << "  UMON_HIT: " << setw(10) << umon_hit[i] << endl;
+    }
+}
@@ -0,0 +1,114 @@
+#include "uop_cache.h"
+
+UOP_CACHE::UOP_CACHE()
+{
+    for (uint32_t i=0; i<UOP_CACHE_SET; i++)
+        for (uint32_t j=0; j<UOP_CACHE_WAY; j++)
+            block[i][j].lru = j;
+
+    delivering_hits = 0;
+    switch_resume_cycle = 0;
+
+    reset_stats();
+}
+
+int UOP_CACHE::find(uint64_t ip)
+{
+    uint64_t window = ip >> LOG2_UOP_CACHE_WINDOW;
+    uint32_t set = window & (UOP_CACHE_SET - 1);
+
+    for (uint32_t i=0; i<UOP_CACHE_WAY; i++) {
+        if (block[set][i].valid && (block[set][i].window == window))
+            return i;
+    }
+
+    return -1;
+}
+
+void UOP_CACHE::update_lru(uint32_t set, uint32_t way)
+{
+    for (uint32_t i=0; i<UOP_CACHE_WAY; i++) {
+        if (block[set][i].lru < block[set][way].lru)
+            block[set][i].lru++;
+    }
+    block[set][way].lru = 0;
+}
+
+uint8_t UOP_CACHE::probe(uint64_t ip)
+{
+    int way = find(ip);
+    if (way == -1)
+        return 0;
+
+    uint32_t set = (ip >> LOG2_UOP_CACHE_WINDOW) & (UOP_CACHE_SET - 1);
+    return (block[set][way].offsets >> (ip & ((1 << LOG2_UOP_CACHE_WINDOW) - 1))) & 1;
+}
+
+uint8_t UOP_CACHE::lookup(uint64_t ip)
+{
+    accesses++;
+
+    if (!probe(ip))
+        return 0;
+
+    update_lru((ip >> LOG2_UOP_CACHE_WINDOW) & (UOP_CACHE_SET - 1), find(ip));
+    hits++;
+    return 1;
+}
+
+void UOP_CACHE::fill(uint64_t ip)
+{
+    uint32_t set = (ip >> LOG2_UOP_CACHE_WINDOW) & (UOP_CACHE_SET - 1);
+
+    int way = find(ip);
+    if (way == -1) {
+        for (way=0; way<UOP_CACHE_WAY; way++) {
+            if (block[set][way].lru == (UOP_CACHE_WAY-1))
+                break;
+        }
+
+        block[set][way].valid = 1;
+        block[set][way].window = ip >> LOG2_UOP_CACHE_WINDOW;
+        block[set][way].offsets = 0;
+        fills++;
+    }
+
+    // the instructions past the capacity of the entry always go through the legacy decoders
+    if (__builtin_popcount(block[set][way].offsets) < UOP_CACHE_WINDOW_UOPS)
+        block[set][way].offsets |= 1u << (ip & ((1 << LOG2_UOP_CACHE_WINDOW) - 1));
+
+    update_lru(set, way);
+}
+
+uint8_t UOP_CACHE::deliver(uint8_t hit, uint64_t cycle)
+{
+    if (cycle < switch_resume_cycle)
+        return 0;
+
+    // the rest of this cycle is lost too, and counted with the penalty
+    if (hit != delivering_hits) {
+        delivering_hits = hit;
+        switches++;
+        switch_cycles += 1 + UOP_CACHE_SWITCH_PENALTY;
+        switch_resume_cycle = cycle + 1 + UOP_CACHE_SWITCH_PENALTY;
+        return 0;
+    }
+
+    return 1;
+}
+
+void UOP_CACHE::reset_stats()
+{
+    accesses = 0;
+    hits = 0;
+    fills = 0;
+    switches = 0;
+    switch_cycles = 0;
+}
+
+void UOP_CACHE::print_stats(uint32_t cpu)
+{
+    cout << "CPU " << cpu << " UOP CACHE  ACCESS: " << setw(10) << accesses << "  HIT: " << setw(10) << hits << "  MISS: " << setw(10) << accesses - hits;
+    cout << "  HIT RATE: " << (accesses ? (100.0*hits) / accesses : 0) << "%" << endl;
+    cout << "CPU " << cpu << " UOP CACHE  FILLS: " << setw(10) << fills << "  SWITCHES: " << setw(10) << switches << "  SWITCH CYCLES: " << setw(10) << switch_cycles << endl;
+}
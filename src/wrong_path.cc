@@ -0,0 +1,159 @@
+#include "wrong_path.h"
+
+WRONG_PATH::WRONG_PATH()
+{
+    for (uint32_t i=0; i<WRONG_PATH_LINES; i++) {
+        recent_lines[i] = 0;
+        recent_loads[i] = 0;
+        recent_load_ips[i] = 0;
+    }
+    num_recent = 0;
+
+    next_line = 0;
+    armed = 0;
+    active = 0;
+    last_page = 0;
+
+    armed_key = 0;
+    armed_ip = 0;
+    armed_target = 0;
+
+    reset_stats();
+}
+
+void WRONG_PATH::record(ooo_model_instr *instr)
+{
+    uint64_t line = instr->ip >> LOG2_BLOCK_SIZE;
+
+    if ((num_recent == 0) || (line != recent_lines[(num_recent-1) % WRONG_PATH_LINES])) {
+        // the branches WRONG_PATH_LINES lines ago have their whole path, before the oldest line is overwritten
+        while (pending.size() && ((num_recent - pending.front().second) == WRONG_PATH_LINES)) {
+            WRONG_PATH_ENTRY &entry = paths[index(pending.front().first)];
+            entry.key = pending.front().first;
+            for (uint32_t i=0; i<WRONG_PATH_LINES; i++) {
+                uint32_t slot = (pending.front().second + i) % WRONG_PATH_LINES;
+                entry.lines[i] = recent_lines[slot];
+                entry.loads[i] = recent_loads[slot];
+                entry.load_ips[i] = recent_load_ips[slot];
+            }
+            entry.num_lines = WRONG_PATH_LINES;
+
+            pending.pop_front();
+        }
+
+        uint32_t slot = num_recent % WRONG_PATH_LINES;
+        recent_lines[slot] = line;
+        recent_loads[slot] = 0;
+        recent_load_ips[slot] = 0;
+        num_recent++;
+    }
+
+    uint32_t slot = (num_recent-1) % WRONG_PATH_LINES;
+    for (uint32_t i=0; (i<NUM_INSTR_SOURCES) && (recent_loads[slot] == 0); i++) {
+        if (instr->source_memory[i]) {
+            recent_loads[slot] = instr->source_memory[i];
+            recent_load_ips[slot] = instr->ip;
+        }
+    }
+
+    // a branch that already went the same way in this line gets the same path, and the oldest
+    // recordings are the closest to done, so the new ones wait when there are too many
+    if (instr->is_branch && (pending.size() < WRONG_PATH_PENDING)) {
+        uint64_t branch_key = key(instr->ip, instr->branch_taken);
+        for (deque<pair<uint64_t, uint64_t> >::reverse_iterator it=pending.rbegin(); (it != pending.rend()) && (it->second == num_recent); it++) {
+            if (it->first == branch_key)
+                return;
+        }
+
+        pending.push_back(make_pair(branch_key, num_recent));
+    }
+}
+
+void WRONG_PATH::arm(uint64_t ip, uint8_t taken, uint64_t target)
+{
+    armed = 1;
+    armed_key = key(ip, taken);
+    armed_ip = ip;
+    armed_target = taken ? target : 0;
+}
+
+void WRONG_PATH::start()
+{
+    if (!armed)
+        return;
+    armed = 0;
+
+    WRONG_PATH_ENTRY &entry = paths[index(armed_key)];
+    if (entry.key == armed_key) {
+        current = entry;
+        paths_replayed++;
+    }
+    else {
+        // never seen: straight-line code from the predicted target or the fall-through, within its page
+        uint64_t first = armed_target ? (armed_target >> LOG2_BLOCK_SIZE) : ((armed_ip >> LOG2_BLOCK_SIZE) + 1);
+        if ((armed_key & 1) && (armed_target == 0))
+            return;
+
+        current = WRONG_PATH_ENTRY();
+        for (uint64_t cl=first; current.num_lines<WRONG_PATH_LINES; cl++) {
+            if ((cl >> (LOG2_PAGE_SIZE - LOG2_BLOCK_SIZE)) != (first >> (LOG2_PAGE_SIZE - LOG2_BLOCK_SIZE)))
+                break;
+            current.lines[current.num_lines++] = cl;
+        }
+    }
+
+    active = 1;
+    next_line = 0;
+    last_page = 0;
+    paths_fetched++;
+}
+
+void WRONG_PATH::stop()
+{
+    armed = 0;
+    active = 0;
+}
+
+uint64_t WRONG_PATH::line()
+{
+    if (!active || (next_line >= current.num_lines))
+        return 0;
+
+    return current.lines[next_line] << LOG2_BLOCK_SIZE;
+}
+
+uint64_t WRONG_PATH::load(uint64_t &ip)
+{
+    ip = current.load_ips[next_line];
+    return current.loads[next_line];
+}
+
+void WRONG_PATH::advance()
+{
+    next_line++;
+    lines_fetched++;
+}
+
+uint64_t WRONG_PATH::key(uint64_t ip, uint8_t taken)
+{
+    return (ip << 1) | taken;
+}
+
+uint32_t WRONG_PATH::index(uint64_t path_key)
+{
+    return (path_key ^ (path_key >> 13) ^ (path_key >> 26)) & (WRONG_PATH_SET - 1);
+}
+
+void WRONG_PATH::reset_stats()
+{
+    paths_fetched = 0;
+    paths_replayed = 0;
+    lines_fetched = 0;
+    loads_issued = 0;
+}
+
+void WRONG_PATH::print_stats(uint32_t cpu)
+{
+    cout << "CPU " << cpu << " WRONG PATH  PATHS: " << setw(10) << paths_fetched << "  REPLAYED: " << setw(10) << paths_replayed;
+    cout << "  LINES: " << setw(10) << lines_fetched << "  LOADS: " << setw(10) << loads_issued << endl;
+}